@@ -8,8 +8,137 @@
 #ifndef ACCTABLE_H_
 #define ACCTABLE_H_
 
+#include "avr/pgmspace.h"
+#include "parameters.h"
+#include "src/hardware/hardware.h"
 
 #define SPEED_TABLE_END 1023
+// the acceleration the table is built for, in steps/s/s. See acctable.cpp
+#define TABLE_ACCELERATION 4000L
+// an acceleration in mm/s/s as steps/s/s. Each wheel makes half of STEPS_FOR_ONE_METER
+#define ACCELERATION_STEPS(MM) (((MM) * STEPS_FOR_ONE_METER) / 2000L)
 unsigned int accTable(int speed);
 
+/***
+ * The acceleration tables are worked out by the compiler. See acctable.cpp
+ * for the arithmetic.
+ *
+ * AccelerationTable<a> holds the timer count for every step of a constant
+ * acceleration of a steps/s/s from rest, up to an index of END. It is a
+ * class template so a table is only put into flash when some code reads
+ * from it. A table for another acceleration, or length, costs 2 bytes an
+ * entry and nothing else.
+ */
+
+// the largest r with r*r <= x, found by bisection between lo and hi
+constexpr unsigned long long accSqrt(unsigned long long x, unsigned long long lo = 0,
+                                     unsigned long long hi = 0xffffffffULL) {
+  return (lo >= hi) ? lo
+         : ((lo + hi + 1) / 2) * ((lo + hi + 1) / 2) <= x ? accSqrt(x, (lo + hi + 1) / 2, hi)
+         : accSqrt(x, lo, (lo + hi + 1) / 2 - 1);
+}
+
+// true if d <= 65536*(sqrt(n+1)-sqrt(n)), which is d*(sqrt(n+1)+sqrt(n)) <= 65536.
+// Squared twice that only needs whole numbers and, for n up to 4094, fits in 64 bits
+constexpr bool accStepFits(unsigned long long n, unsigned long long d) {
+  return (2 * n + 1) * d * d <= (1ULL << 32)
+         && 4 * d * d * d * d * n * (n + 1) <= ((1ULL << 32) - (2 * n + 1) * d * d) * ((1ULL << 32) - (2 * n + 1) * d * d);
+}
+
+// the roots with 10 extra bits give a difference within one of the answer
+constexpr unsigned int accStepNear(unsigned long long n, unsigned long long d) {
+  return accStepFits(n, d + 1) ? d + 1 : accStepFits(n, d) ? d : d - 1;
+}
+
+// the entries of the table typed in in 2016 that are one less than the
+// equation gives. Its generator was short of precision. They are kept for
+// TABLE_ACCELERATION so that the motors step exactly as they always have
+constexpr unsigned int ACC_STEPS_LOW[] = {
+  9, 11, 12, 18, 19, 32, 99, 115, 125, 133, 135, 142, 157, 216, 229, 232, 254, 255, 256,
+  257, 265, 272, 279, 302, 332, 343, 375, 434, 447, 532, 660, 690, 759, 833, 857, 895, 979
+};
+
+constexpr bool accStepLow(unsigned long n, unsigned int i = 0) {
+  return i < sizeof(ACC_STEPS_LOW) / sizeof(ACC_STEPS_LOW[0])
+         && (ACC_STEPS_LOW[i] == n || (ACC_STEPS_LOW[i] < n && accStepLow(n, i + 1)));
+}
+
+// 65536*(sqrt(n+1)-sqrt(n)) rounded down. Entry 0 is clipped to fit a word
+constexpr unsigned int accStep(unsigned long n) {
+  return (n == 0) ? 65535 : accStepNear(n, (accSqrt((n + 1ULL) << 52) - accSqrt((unsigned long long)n << 52)) >> 10);
+}
+
+// accStep() as typed in in 2016
+constexpr unsigned int accStep2016(unsigned long n) {
+  return accStep(n) - (accStepLow(n) ? 1 : 0);
+}
+
+// the counts for the first step from rest, F_COUNTER * sqrt(2/a)
+constexpr unsigned long accCountZero(long acceleration) {
+  return (unsigned long)accSqrt((2ULL * F_COUNTER * F_COUNTER) / acceleration);
+}
+
+// the timer counts for step n at an acceleration of a steps/s/s. Only the
+// default acceleration uses the 2016 steps; the others are exact
+constexpr unsigned int accCount(long acceleration, unsigned long n) {
+  return (unsigned int)(((unsigned long)(acceleration == TABLE_ACCELERATION ? accStep2016(n) : accStep(n))
+                         * accCountZero(acceleration)) >> 16);
+}
+
+// a list of table indexes. The list is built by joining halves so the
+// template nesting only grows with the log of the table size
+template<unsigned int... N>
+struct AccIndices {
+};
+
+template<class A, class B>
+struct AccJoin;
+
+template<unsigned int... A, unsigned int... B>
+struct AccJoin<AccIndices<A...>, AccIndices<B...> > {
+  typedef AccIndices<A..., (sizeof...(A) + B)...> type;
+};
+
+template<unsigned int COUNT>
+struct AccRange {
+  typedef typename AccJoin<typename AccRange<COUNT / 2>::type,
+          typename AccRange<COUNT - COUNT / 2>::type>::type type;
+};
+
+template<>
+struct AccRange<0> {
+  typedef AccIndices<> type;
+};
+
+template<>
+struct AccRange<1> {
+  typedef AccIndices<0> type;
+};
+
+template<long ACCELERATION, int END = SPEED_TABLE_END, class INDICES = typename AccRange<END + 1>::type>
+class AccelerationTable;
+
+template<long ACCELERATION, int END, unsigned int... N>
+class AccelerationTable<ACCELERATION, END, AccIndices<N...> > {
+public:
+  static_assert(accCountZero(ACCELERATION) <= 65535, "the acceleration is too low for the timer");
+  static_assert(END > 0 && END < 4095, "the table is too long for accStep()");
+
+  // the timer counts for one step at a speed. Speeds past the end use the last entry
+  static unsigned int interval(int speed) {
+    if (speed > END) {
+      speed = END;
+    }
+    return pgm_read_word_near(counts + speed);
+  }
+
+private:
+  static const unsigned int counts[END + 1];
+};
+
+template<long ACCELERATION, int END, unsigned int... N>
+const unsigned int AccelerationTable<ACCELERATION, END, AccIndices<N...> >::counts[END + 1] PROGMEM = {
+  accCount(ACCELERATION, N)...
+};
+
 #endif /* ACCTABLE_H_ */
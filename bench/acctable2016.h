@@ -0,0 +1,124 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/***
+ * The acceleration table as it was typed into acctable.cpp in 2016, before
+ * the tables were worked out by the compiler. The benchmark checks the
+ * generated tables against it. See checkAccTable() in bench.cpp.
+ */
+
+#ifndef ACCTABLE2016_H
+#define ACCTABLE2016_H
+
+static const unsigned int accTable2016[1024] = {
+  65535, 27145, 20829, 17560, 15470, 13986, 12862, 11971, 11244, 10634, 10115, 9664,
+  9269, 8919, 8606, 8324, 8067, 7833, 7618, 7420, 7237, 7067, 6908, 6759,
+  6620, 6489, 6365, 6248, 6138, 6033, 5933, 5838, 5747, 5661, 5578, 5499,
+  5423, 5351, 5281, 5213, 5149, 5086, 5026, 4968, 4912, 4857, 4805, 4754,
+  4705, 4657, 4611, 4566, 4522, 4479, 4438, 4398, 4359, 4321, 4284, 4248,
+  4212, 4178, 4144, 4112, 4080, 4048, 4018, 3988, 3959, 3930, 3902, 3875,
+  3848, 3822, 3796, 3771, 3746, 3722, 3698, 3675, 3652, 3629, 3607, 3585,
+  3564, 3543, 3523, 3503, 3483, 3463, 3444, 3425, 3407, 3388, 3370, 3353,
+  3335, 3318, 3301, 3284, 3268, 3252, 3236, 3220, 3205, 3190, 3175, 3160,
+  3145, 3131, 3117, 3103, 3089, 3075, 3062, 3048, 3035, 3022, 3010, 2997,
+  2985, 2972, 2960, 2948, 2936, 2924, 2913, 2901, 2890, 2879, 2868, 2857,
+  2846, 2835, 2825, 2814, 2804, 2794, 2784, 2774, 2764, 2754, 2744, 2735,
+  2725, 2716, 2707, 2698, 2688, 2679, 2671, 2662, 2653, 2644, 2636, 2627,
+  2619, 2610, 2602, 2594, 2586, 2578, 2570, 2562, 2554, 2547, 2539, 2531,
+  2524, 2516, 2509, 2502, 2494, 2487, 2480, 2473, 2466, 2459, 2452, 2445,
+  2438, 2432, 2425, 2418, 2412, 2405, 2399, 2393, 2386, 2380, 2374, 2367,
+  2361, 2355, 2349, 2343, 2337, 2331, 2325, 2319, 2314, 2308, 2302, 2297,
+  2291, 2285, 2280, 2274, 2269, 2263, 2258, 2253, 2247, 2242, 2237, 2232,
+  2226, 2221, 2216, 2211, 2206, 2201, 2196, 2191, 2186, 2182, 2177, 2172,
+  2167, 2162, 2158, 2153, 2148, 2144, 2139, 2135, 2130, 2126, 2121, 2117,
+  2112, 2108, 2104, 2099, 2095, 2091, 2087, 2082, 2078, 2074, 2070, 2066,
+  2062, 2058, 2053, 2049, 2045, 2041, 2038, 2034, 2030, 2026, 2022, 2018,
+  2014, 2010, 2007, 2003, 1999, 1996, 1992, 1988, 1984, 1981, 1977, 1974,
+  1970, 1967, 1963, 1959, 1956, 1953, 1949, 1946, 1942, 1939, 1935, 1932,
+  1929, 1925, 1922, 1919, 1915, 1912, 1909, 1906, 1902, 1899, 1896, 1893,
+  1890, 1887, 1883, 1880, 1877, 1874, 1871, 1868, 1865, 1862, 1859, 1856,
+  1853, 1850, 1847, 1844, 1841, 1838, 1836, 1833, 1830, 1827, 1824, 1821,
+  1819, 1816, 1813, 1810, 1807, 1805, 1802, 1799, 1796, 1794, 1791, 1788,
+  1786, 1783, 1781, 1778, 1775, 1773, 1770, 1767, 1765, 1762, 1760, 1757,
+  1755, 1752, 1750, 1747, 1745, 1742, 1740, 1737, 1735, 1733, 1730, 1728,
+  1725, 1723, 1721, 1718, 1716, 1713, 1711, 1709, 1706, 1704, 1702, 1700,
+  1697, 1695, 1693, 1690, 1688, 1686, 1684, 1682, 1679, 1677, 1675, 1673,
+  1671, 1668, 1666, 1664, 1662, 1660, 1658, 1656, 1653, 1651, 1649, 1647,
+  1645, 1643, 1641, 1639, 1637, 1635, 1633, 1631, 1629, 1627, 1625, 1623,
+  1621, 1619, 1617, 1615, 1613, 1611, 1609, 1607, 1605, 1603, 1601, 1599,
+  1597, 1596, 1594, 1592, 1590, 1588, 1586, 1584, 1582, 1581, 1579, 1577,
+  1575, 1573, 1571, 1570, 1568, 1566, 1564, 1563, 1561, 1559, 1557, 1555,
+  1554, 1552, 1550, 1548, 1547, 1545, 1543, 1542, 1540, 1538, 1537, 1535,
+  1533, 1531, 1530, 1528, 1526, 1525, 1523, 1522, 1520, 1518, 1517, 1515,
+  1513, 1512, 1510, 1509, 1507, 1505, 1504, 1502, 1501, 1499, 1497, 1496,
+  1494, 1493, 1491, 1490, 1488, 1487, 1485, 1484, 1482, 1481, 1479, 1478,
+  1476, 1475, 1473, 1472, 1470, 1469, 1467, 1466, 1464, 1463, 1461, 1460,
+  1458, 1457, 1455, 1454, 1453, 1451, 1450, 1448, 1447, 1446, 1444, 1443,
+  1441, 1440, 1439, 1437, 1436, 1434, 1433, 1432, 1430, 1429, 1428, 1426,
+  1425, 1424, 1422, 1421, 1419, 1418, 1417, 1416, 1414, 1413, 1412, 1410,
+  1409, 1408, 1406, 1405, 1404, 1402, 1401, 1400, 1399, 1397, 1396, 1395,
+  1394, 1392, 1391, 1390, 1389, 1387, 1386, 1385, 1384, 1382, 1381, 1380,
+  1379, 1377, 1376, 1375, 1374, 1373, 1371, 1370, 1369, 1368, 1367, 1365,
+  1364, 1363, 1362, 1361, 1360, 1358, 1357, 1356, 1355, 1354, 1353, 1351,
+  1350, 1349, 1348, 1347, 1346, 1345, 1343, 1342, 1341, 1340, 1339, 1338,
+  1337, 1336, 1334, 1333, 1332, 1331, 1330, 1329, 1328, 1327, 1326, 1325,
+  1324, 1322, 1321, 1320, 1319, 1318, 1317, 1316, 1315, 1314, 1313, 1312,
+  1311, 1310, 1309, 1308, 1307, 1306, 1304, 1303, 1302, 1301, 1300, 1299,
+  1298, 1297, 1296, 1295, 1294, 1293, 1292, 1291, 1290, 1289, 1288, 1287,
+  1286, 1285, 1284, 1283, 1282, 1281, 1280, 1279, 1278, 1277, 1276, 1275,
+  1274, 1274, 1273, 1272, 1271, 1270, 1269, 1268, 1267, 1266, 1265, 1264,
+  1263, 1262, 1261, 1260, 1259, 1258, 1257, 1257, 1256, 1255, 1254, 1253,
+  1252, 1251, 1250, 1249, 1248, 1247, 1246, 1246, 1245, 1244, 1243, 1242,
+  1241, 1240, 1239, 1238, 1238, 1237, 1236, 1235, 1234, 1233, 1232, 1231,
+  1231, 1230, 1229, 1228, 1227, 1226, 1225, 1225, 1224, 1223, 1222, 1221,
+  1220, 1219, 1219, 1218, 1217, 1216, 1215, 1214, 1214, 1213, 1212, 1211,
+  1210, 1209, 1209, 1208, 1207, 1206, 1205, 1204, 1204, 1203, 1202, 1201,
+  1200, 1200, 1199, 1198, 1197, 1196, 1196, 1195, 1194, 1193, 1192, 1192,
+  1191, 1190, 1189, 1188, 1188, 1187, 1186, 1185, 1185, 1184, 1183, 1182,
+  1182, 1181, 1180, 1179, 1178, 1178, 1177, 1176, 1175, 1175, 1174, 1173,
+  1172, 1172, 1171, 1170, 1169, 1169, 1168, 1167, 1166, 1166, 1165, 1164,
+  1163, 1163, 1162, 1161, 1161, 1160, 1159, 1158, 1158, 1157, 1156, 1155,
+  1155, 1154, 1153, 1153, 1152, 1151, 1150, 1150, 1149, 1148, 1148, 1147,
+  1146, 1146, 1145, 1144, 1143, 1143, 1142, 1141, 1141, 1140, 1139, 1139,
+  1138, 1137, 1137, 1136, 1135, 1134, 1134, 1133, 1132, 1132, 1131, 1130,
+  1130, 1129, 1128, 1128, 1127, 1126, 1126, 1125, 1124, 1124, 1123, 1122,
+  1122, 1121, 1120, 1120, 1119, 1118, 1118, 1117, 1117, 1116, 1115, 1115,
+  1114, 1113, 1113, 1112, 1111, 1111, 1110, 1109, 1109, 1108, 1108, 1107,
+  1106, 1106, 1105, 1104, 1104, 1103, 1103, 1102, 1101, 1101, 1100, 1099,
+  1099, 1098, 1098, 1097, 1096, 1096, 1095, 1094, 1094, 1093, 1093, 1092,
+  1091, 1091, 1090, 1090, 1089, 1088, 1088, 1087, 1087, 1086, 1085, 1085,
+  1084, 1084, 1083, 1082, 1082, 1081, 1081, 1080, 1080, 1079, 1078, 1078,
+  1077, 1077, 1076, 1075, 1075, 1074, 1074, 1073, 1073, 1072, 1071, 1071,
+  1070, 1070, 1069, 1069, 1068, 1067, 1067, 1066, 1066, 1065, 1065, 1064,
+  1063, 1063, 1062, 1062, 1061, 1061, 1060, 1060, 1059, 1058, 1058, 1057,
+  1057, 1056, 1056, 1055, 1055, 1054, 1054, 1053, 1052, 1052, 1051, 1051,
+  1050, 1050, 1049, 1049, 1048, 1048, 1047, 1046, 1046, 1045, 1045, 1044,
+  1044, 1043, 1043, 1042, 1042, 1041, 1041, 1040, 1040, 1039, 1039, 1038,
+  1038, 1037, 1036, 1036, 1035, 1035, 1034, 1034, 1033, 1033, 1032, 1032,
+  1031, 1031, 1030, 1030, 1029, 1029, 1028, 1028, 1027, 1027, 1026, 1026,
+  1025, 1025, 1024, 1024,
+};
+
+#endif // ACCTABLE2016_H
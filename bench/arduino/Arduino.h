@@ -0,0 +1,167 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/***
+ * A thin stand-in for the Arduino core so that the maze and path code can
+ * be built and benchmarked on a Linux host. Only what the sketch sources
+ * used by the benchmark need is provided. Nothing here drives any hardware.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "avr/pgmspace.h"
+#include "avr/interrupt.h"
+
+#define ARDUINO 10800
+#define F_CPU 16000000L
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define A0 18
+#define A1 19
+#define A2 20
+#define A3 21
+#define A4 22
+#define A5 23
+
+// the fast pin macros stop digitalwritefast.h rejecting a non-AVR build
+#define digitalWriteFast(P, V) digitalWrite((P), (V))
+#define pinModeFast(P, V) pinMode((P), (V))
+#define digitalReadFast(P) digitalRead((P))
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+// as in the Arduino core, all printing goes through write(). By default
+// that is to stderr so that stdout only holds results
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) {
+    return fputc(c, stderr) == EOF ? 0 : 1;
+  }
+  size_t write(const char *s) {
+    size_t n = 0;
+    while (*s) {
+      n += write((uint8_t)*s++);
+    }
+    return n;
+  }
+  size_t print(const __FlashStringHelper *s) {
+    return write((const char *)s);
+  }
+  size_t print(const char *s) {
+    return write(s);
+  }
+  size_t print(char c) {
+    return write((uint8_t)c);
+  }
+  size_t print(long value, int base = DEC) {
+    char text[24];
+    snprintf(text, sizeof(text), (base == HEX) ? "%lX" : "%ld", value);
+    return write(text);
+  }
+  size_t print(unsigned long value, int base = DEC) {
+    char text[24];
+    snprintf(text, sizeof(text), (base == HEX) ? "%lX" : "%lu", value);
+    return write(text);
+  }
+  size_t print(int value, int base = DEC) {
+    return print((long)value, base);
+  }
+  size_t print(unsigned int value, int base = DEC) {
+    return print((unsigned long)value, base);
+  }
+  size_t print(unsigned char value, int base = DEC) {
+    return print((unsigned long)value, base);
+  }
+  size_t print(double value, int digits = 2) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+  }
+  size_t println() {
+    return write("\r\n");
+  }
+  template <class T> size_t println(T value) {
+    return print(value) + println();
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() {
+    return 0;
+  }
+  virtual int read() {
+    return -1;
+  }
+  virtual int peek() {
+    return -1;
+  }
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(long) {}
+};
+
+extern HardwareSerial Serial1;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+int analogRead(int pin);
+
+#define noInterrupts() cli()
+#define interrupts() sei()
+
+#define constrain(x, a, b) ((x) < (a) ? (a) : ((x) > (b) ? (b) : (x)))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+#endif // ARDUINO_H
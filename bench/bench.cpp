@@ -0,0 +1,1101 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/***
+ * Host benchmark for the maze flood and path planning code.
+ *
+ * The sketch sources for the maze, the planner and the path functions in
+ * mouse.cpp are built unchanged against the stand-in Arduino headers in
+ * arduino/. Each maze in the corpus is put through the same operations the
+ * mouse uses and the results are written to stdout as CSV with one line
+ * for each maze and operation:
+ *
+ *   maze,op,ns_per_op,dequeued,path_length,sim_ms,pruned
+ *
+ * dequeued is the number of cells taken from the work queue by one
+ * operation and path_length is the number of cells moved. Both are exact
+ * and only change when the algorithms change. For the simulated searches
+ * and speed runs, sim_ms is the time the mouse would take to make the
+ * moves, estimated from the acceleration table. It is -1 for the other operations.
+ * pruned is the number of dead end cells in the map a simulated search
+ * leaves behind, and -1 for the other operations.
+ * ns_per_op is the best of five timed batches. The benchmark is built with QUEUE_DEBUG so that
+ * the queue counts its removals. That adds a little to the flood times.
+ *
+ * The corpus is the two sample mazes, a set of seeded random mazes and any
+ * maze files named on the command line. Files ending in .maz are read as
+ * binary and anything else as text. See mazefile.h for the formats.
+ *
+ * Usage: bench [-t ms] [-c baseline.csv] [-r percent] [maze file ...]
+ *
+ *   -t  the minimum time for each timed batch. Default 20ms
+ *   -c  compare with an earlier run. Any change in dequeued or path_length,
+ *       a slower simulated run, or a time more than the tolerance slower, is a
+ *       regression.
+ *   -r  the tolerance for timing regressions. Default 15 percent
+ *
+ * The exit status is 1 if there were regressions, if a search that
+ * stopped once the route was proven, or an exploring search, did not
+ * find the shortest route, if a diagonal path does not follow the maze
+ * to the goal, if the dual flood disagrees with the two floods it
+ * replaces, if a route search disagrees with the flood, if a cached
+ * path is kept when it should not be, or not kept when it should, or if
+ * an acceleration table is not exactly as it should be.
+ */
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Arduino.h"
+#include "../maze.h"
+#include "../planner.h"
+#include "../mazefile.h"
+#include "../src/hardware/mouse.h"
+#include "../src/hardware/queue.h"
+#include "../parameters.h"
+#include "../runplan.h"
+#include "../acctable.h"
+#include "acctable2016.h"
+#include "standin.h"
+
+typedef Queue<cell_t, FLOOD_QUEUE_SIZE> FloodQueue;
+
+#define MAX_MAZES 64
+#define MAX_RESULTS 1024
+#define RANDOM_MAZES 8
+
+struct Maze {
+  char name[64];
+  unsigned char walls[MAZE_CELLS];
+};
+
+struct Result {
+  char maze[64];
+  char op[32];
+  double nsPerOp;
+  long dequeued;  // -1 when the operation does not use a queue
+  int pathLength; // -1 when the operation does not make a path
+  double simMs;    // simulated running time, -1 when not simulated
+  int pruned;     // dead end cells at the end of a search, -1 when not a search
+};
+
+static Maze corpus[MAX_MAZES];
+static int mazeCount = 0;
+static Result results[MAX_RESULTS];
+static int resultCount = 0;
+static double minBatchTime = 20e6;  // nanoseconds
+
+static const Maze *currentMaze;
+static bool contestRules;	// the current maze follows the rules that walls are inferred from
+static bool searchFastKnown;	// for mouse.fastKnown in the simulated searches
+static cell_t searchSteps;
+static int routeFailures = 0;
+
+/***
+ * Time an operation in batches, doubling the batch size until a batch takes
+ * at least the minimum time. The best of five such batches is returned as
+ * the time for a single call.
+ */
+static double timeOperation(void (*operation)()) {
+  long count = 1;
+  double best = 0;
+  for (int batch = 0; batch < 5;) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 0; i < count; i++) {
+      operation();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    if (ns < minBatchTime) {
+      count *= 2;
+      continue;
+    }
+    if (batch == 0 || ns / count < best) {
+      best = ns / count;
+    }
+    batch++;
+  }
+  return best;
+}
+
+static void addResult(const char *op, double ns, long dequeued, int pathLength, double simMs, int pruned = -1) {
+  if (resultCount >= MAX_RESULTS) {
+    fprintf(stderr, "too many results\n");
+    exit(2);
+  }
+  Result &r = results[resultCount++];
+  snprintf(r.maze, sizeof(r.maze), "%s", currentMaze->name);
+  snprintf(r.op, sizeof(r.op), "%s", op);
+  r.nsPerOp = ns;
+  r.dequeued = dequeued;
+  r.pathLength = pathLength;
+  r.simMs = simMs;
+  r.pruned = pruned;
+}
+
+static void loadWalls(const unsigned char *source) {
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    walls[i] = source[i] & 0x0f;
+  }
+  mazeSyncBitboards();
+}
+
+// the eight walls around the goal
+static const cell_t goalCells[8] = {GOAL, GOAL + MAZE_HEIGHT, GOAL + 1, GOAL + MAZE_HEIGHT + 1,
+                                    GOAL, GOAL + 1, GOAL + MAZE_HEIGHT, GOAL + MAZE_HEIGHT + 1
+                                   };
+static const unsigned char goalSides[8] = {SOUTH, SOUTH, NORTH, NORTH, WEST, WEST, EAST, EAST};
+
+// true if the post at the south west corner of the cell touches a wall
+static bool postHasWall(cell_t cell) {
+  return hasWall(cell, WEST) || hasWall(cell, SOUTH) || hasWall(cellSouth(cell), WEST) || hasWall(cellWest(cell), SOUTH);
+}
+
+/***
+ * Check the maze in walls[] against the contest rules that
+ * mazeInferWalls() relies on. The searches are only allowed to infer
+ * walls in mazes that pass.
+ */
+static bool followsContestRules() {
+  for (int col = 1; col < MAZE_WIDTH; col++) {
+    for (int row = 1; row < MAZE_HEIGHT; row++) {
+      cell_t cell = row + MAZE_HEIGHT * col;
+      if (cell != GOAL + MAZE_HEIGHT + 1 && !postHasWall(cell)) {
+        return false;
+      }
+    }
+  }
+  int entrances = 0;
+  for (int i = 0; i < 8; i++) {
+    if (hasExit(goalCells[i], goalSides[i])) {
+      entrances++;
+    }
+  }
+  return entrances == 1 && hasExit(GOAL, NORTH) && hasExit(GOAL, EAST) &&
+         hasExit(GOAL + 1, EAST) && hasExit(GOAL + MAZE_HEIGHT, NORTH);
+}
+
+// the number of cells moved in a path string
+static int pathCells(const char *pathString) {
+  int cells = 0;
+  for (int i = 0; pathString[i]; i++) {
+    if (strchr("FRLA", pathString[i])) {
+      cells++;
+    }
+  }
+  return cells;
+}
+
+static void opFlood() {
+  mazeFlood(GOAL);
+}
+
+static void opFloodRegion() {
+  mazeFlood(GOAL_REGION);
+}
+
+// from every cell in turn so the time is the average over the maze
+static cell_t floodFrom;
+
+static void opFloodTo() {
+  mazeFloodTo(GOAL_REGION, floodFrom++);
+}
+
+static void opRoute() {
+  unsigned char heading;
+  pathRoute(floodFrom++, GOAL_REGION, false, heading);
+}
+
+static void opRouteHome() {
+  unsigned char heading;
+  pathRoute(GOAL, 0, false, heading);
+}
+
+static void opFloodDual() {
+  mazeFloodDual(GOAL_REGION);
+}
+
+static void opFloodBits() {
+  mazeFloodBits(GOAL);
+}
+
+static void opDirections() {
+  for (int cell = 0; cell < MAZE_CELLS; cell++) {
+    directionToSmallest(cell, NORTH);
+  }
+}
+
+static void opPathGenerate() {
+  pathGenerate(0);
+}
+
+static char savedPath[MAZE_CELLS];
+static int planMoves;
+
+static void opRunPlan() {
+  RunPlan plan;
+  runPlanBegin(plan, savedPath, RUN_SMOOTH);
+  planMoves = 0;
+  while (runPlanNext(plan)) {
+    planMoves += plan.count;
+  }
+}
+
+/***
+ * A speed run along the path in path[] by mouseRunPath(), timed in the
+ * stand-in simulator.
+ */
+static unsigned char runStyle;
+
+static void opRun() {
+  mouse.location = 0;
+  mouse.heading = plannerDirection(0, NORTH);
+  simulatorTime = 0;
+  mouseRunPath(runStyle, SPEEDMAX_STRAIGHT);
+}
+
+static void opPlannerFlood() {
+  plannerFlood(GOAL_REGION, RUN_SMOOTH);
+}
+
+static void opPlannerDiagonal() {
+  plannerFlood(GOAL_REGION, RUN_DIAGONAL);
+}
+
+// true if path[] can be driven through the open walls from the cell to the
+// targets. With knownOnly set, every passage must have been seen to be open
+static bool pathReaches(cell_t cell, unsigned char heading, const CellSet &targets, bool knownOnly = false) {
+  for (int i = 0; path[i]; i++) {
+    switch (path[i]) {
+      case 'R':
+        heading = DtoR[heading];
+        break;
+      case 'L':
+        heading = DtoL[heading];
+        break;
+      case 'A':
+        heading = DtoB[heading];
+        break;
+      case 'F':
+        break;
+      default:
+        continue;
+    }
+    if (knownOnly ? !hasKnownExit(cell, heading) : !hasExit(cell, heading)) {
+      return false;
+    }
+    cell = neighbour(cell, heading);
+  }
+  return targets.contains(cell);
+}
+
+static bool pathReachesGoal() {
+  return pathReaches(0, plannerDirection(0, NORTH), GOAL_REGION);
+}
+
+/***
+ * The route search from every cell to the goal must be as long as the
+ * flood says and must follow the maze all the way.
+ */
+static void checkRoutes() {
+  mazeFlood(GOAL_REGION);
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    unsigned char heading;
+    int length = pathRoute(i, GOAL_REGION, false, heading);
+    int expected = cost[i] == MAX_COST ? -1 : cost[i];
+    if (length != expected || (length >= 0 && (pathCells(path) != length || !pathReaches(i, heading, GOAL_REGION)))) {
+      fprintf(stderr, "%s: the route from cell %d does not match the flood\n", currentMaze->name, i);
+      routeFailures++;
+      return;
+    }
+  }
+}
+
+/***
+ * The longest route there can be visits every cell. In a maze that snakes
+ * up and down the columns, the route from the start to the far end must
+ * fit in path[] with its 'B', 'S' and the end of the string.
+ */
+static void checkLongestRoute() {
+  mazeInit(NULL);
+  for (int col = 0; col < MAZE_WIDTH - 1; col++) {
+    // the way into the next column is at the top of an even one
+    int gap = (col % 2 == 0) ? MAZE_HEIGHT - 1 : 0;
+    for (int row = 0; row < MAZE_HEIGHT; row++) {
+      if (row != gap) {
+        mazeSetWall(col * MAZE_HEIGHT + row, EAST);
+      }
+    }
+  }
+  cell_t end = (MAZE_WIDTH - 1) * MAZE_HEIGHT + ((MAZE_WIDTH % 2 == 0) ? 0 : MAZE_HEIGHT - 1);
+  unsigned char heading = NORTH;
+  int length = pathRoute(0, end, false, heading);
+  if (length != MAZE_CELLS - 1 || pathCells(path) != length || !pathReaches(0, heading, end) ||
+      path[length + 1] != 'S' || path[length + 2] != 0) {
+    fprintf(stderr, "the longest route is %d moves and should be %d\n", length, MAZE_CELLS - 1);
+    routeFailures++;
+  }
+}
+
+/***
+ * The speed runs after a search must only use the passages the search has
+ * seen, whatever the walls in the cells it did not visit.
+ */
+static void checkSpeedRunPaths() {
+  const unsigned char styles[] = {PATH_SHORTEST, RUN_INPLACE, RUN_SMOOTH, RUN_DIAGONAL};
+  for (unsigned char i = 0; i < sizeof(styles); i++) {
+    pathPlan(0, styles[i], true);
+    if (!pathReaches(0, pathHeading, GOAL_REGION, true)) {
+      fprintf(stderr, "%s: the speed run path uses passages the search has not seen\n", currentMaze->name);
+      routeFailures++;
+      return;
+    }
+  }
+}
+
+static void opPlannerPath() {
+  plannerPathGenerate(0);
+}
+
+// a change to the map that pathPlan() has to check the path against
+static void opPlanCached() {
+  mazeGeneration++;
+  pathPlan(0, RUN_SMOOTH);
+}
+
+/***
+ * After walls are added away from a planned path, pathPlan() must keep the
+ * path and it must be as quick as a path planned afresh. A wall across the
+ * path must make it plan again. Every cell is marked visited so that the
+ * path counts as solved and is kept.
+ */
+static void checkPlanCache() {
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    mazeMarkVisited(i);
+  }
+  pathPlan(0, RUN_SMOOTH);
+  // the sides of each cell that the path crosses
+  unsigned char crossed[MAZE_CELLS] = {0};
+  cell_t cell = 0;
+  unsigned char heading = pathHeading;
+  cell_t middle = 0;
+  unsigned char middleHeading = heading;
+  int cells = pathCells(path);
+  for (int i = 0, moves = 0; path[i]; i++) {
+    char c = path[i];
+    if (c == 'R') {
+      heading = DtoR[heading];
+    } else if (c == 'L') {
+      heading = DtoL[heading];
+    } else if (c == 'A') {
+      heading = DtoB[heading];
+    } else if (c != 'F') {
+      continue;
+    }
+    if (moves++ == cells / 2) {
+      middle = cell;
+      middleHeading = heading;
+    }
+    crossed[cell] |= 1 << heading;
+    cell = neighbour(cell, heading);
+    crossed[cell] |= 1 << DtoB[heading];
+  }
+  int passage = 0;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    for (unsigned char direction = NORTH; direction <= EAST; direction++) {
+      if (hasExit(i, direction) && (crossed[i] & (1 << direction)) == 0 && ++passage % 4 == 0) {
+        mazeSetWall(i, direction);
+      }
+    }
+  }
+  unsigned long kept = plannerPathTime(path, RUN_SMOOTH);
+  pathPlan(0, RUN_SMOOTH);
+  bool reused = pathStyle == RUN_SMOOTH && plannerPathTime(path, RUN_SMOOTH) == kept;
+  pathStyle = PATH_NONE;
+  pathPlan(0, RUN_SMOOTH);
+  if (!reused || plannerPathTime(path, RUN_SMOOTH) != kept) {
+    fprintf(stderr, "%s: the cached path is not kept or is not the quickest\n", currentMaze->name);
+    routeFailures++;
+  }
+  addResult("plan_cached", timeOperation(opPlanCached), -1, pathCells(path), -1);
+  if (cells > 0) {
+    mazeSetWall(middle, middleHeading);
+    if (pathPlan(0, RUN_SMOOTH) && !pathReaches(0, pathHeading, GOAL_REGION)) {
+      fprintf(stderr, "%s: the cached path was kept after it was blocked\n", currentMaze->name);
+      routeFailures++;
+    }
+  }
+  // a change of profile changes the times so the path is planned again.
+  // The path is cut short to show whether it was
+  pathPlan(0, RUN_SMOOTH);
+  path[1] = 0;
+  mouse.scurveRuns = !mouse.scurveRuns;
+  pathPlan(0, RUN_SMOOTH);
+  mouse.scurveRuns = !mouse.scurveRuns;
+  if (path[0] && path[1] == 0) {
+    fprintf(stderr, "%s: the cached path was kept after the profile changed\n", currentMaze->name);
+    routeFailures++;
+  }
+  // a wall seen for the first time can open a shorter known route
+  pathPlan(0, RUN_SMOOTH, true);
+  path[1] = 0;
+  mazeLearned++;
+  pathPlan(0, RUN_SMOOTH, true);
+  if (path[0] && path[1] == 0) {
+    fprintf(stderr, "%s: the cached known path was kept after a wall became known\n", currentMaze->name);
+    routeFailures++;
+  }
+}
+
+/***
+ * A simulated search from the start to the goal in the same way as
+ * mouseSearchTo(). The walls of each cell are revealed as it is entered
+ * and the costs are kept up to date with mazeFloodUpdate().
+ */
+static void opSearch() {
+  mazeInit(NULL);
+  mazeMarkVisited(0);
+  cell_t location = 0;
+  unsigned char heading = NORTH;
+  searchSteps = 0;
+  mazeFlood(GOAL_REGION);
+  while (!GOAL_REGION.contains(location) && searchSteps < MAZE_CELLS - 1) {
+    location = neighbour(location, heading);
+    searchSteps++;
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if ((currentMaze->walls[location] & (1 << direction)) && hasExit(location, direction)) {
+        mazeSetWall(location, direction);
+      }
+    }
+    mazeMarkVisited(location);
+    mazeFloodUpdate(location);
+    if (cost[location] == MAX_COST) {
+      break;
+    }
+    heading = directionToSmallest(location, heading);
+  }
+}
+
+/***
+ * A search out to the goal and back to the start by the real search code
+ * in mouse.cpp, run in the stand-in simulator. With mouseSearchTo(), the
+ * mouse goes out and back once. The other searches carry on until the
+ * route is proven so there may be more than one pass. The cells entered
+ * are counted in simulatorCells and the time taken by the moves is
+ * estimated in simulatorTime.
+ */
+static void simulateSearch(int (*search)(const CellSet &target), bool smooth) {
+  mazeInit(NULL);
+  mouse.location = 0;
+  mouse.heading = NORTH;
+  mouse.handStart = false;
+  mouse.smoothSearch = smooth;
+  mouse.inferWalls = contestRules;
+  mouse.fastKnown = searchFastKnown;
+  simulatorWalls = currentMaze->walls;
+  simulatorCells = 0;
+  simulatorTime = 0;
+  simulatorSpeedCuts = 0;
+  if (search == mouseSearchTo) {
+    mouseSearchTo(GOAL_REGION);
+    mouseSearchTo(0);
+  } else {
+    // as mouseRunMaze() does it
+    int result;
+    do {
+      result = search(GOAL_REGION);
+      if (result == 0) {
+        result = search(0);
+      }
+    } while (result == 0 && !mazeRouteProven(0, GOAL_REGION));
+  }
+  simulatorWalls = NULL;
+}
+
+// every move of the simulated search must have slowed down in time for the next
+static void checkSpeedCuts(const char *op) {
+  if (simulatorSpeedCuts > 0) {
+    fprintf(stderr, "%s %s: %ld moves ended too fast\n", currentMaze->name, op, simulatorSpeedCuts);
+    routeFailures++;
+  }
+}
+
+static void opSearchRound() {
+  simulateSearch(mouseSearchTo, false);
+}
+
+static void opSearchSmooth() {
+  simulateSearch(mouseSearchTo, true);
+}
+
+static void opSearchProven() {
+  simulateSearch(mouseSearchUntilProven, false);
+}
+
+static void opSearchExplore() {
+  simulateSearch(mouseSearchExplore, false);
+}
+
+static void opSearchKnown() {
+  searchFastKnown = true;
+  simulateSearch(mouseSearchExplore, false);
+  searchFastKnown = false;
+}
+
+// the length of the shortest route to the goal in the given walls
+static cost_t shortestRoute(const unsigned char *source, bool knownOnly) {
+  if (knownOnly) {
+    mazeFloodKnown(GOAL_REGION);
+  } else {
+    loadWalls(source);
+    mazeFlood(GOAL_REGION);
+  }
+  return cost[0];
+}
+
+/***
+ * Time a single flood and the dual flood on the map left by a search so
+ * that some walls are still unknown. The dual flood must give the same
+ * costs as mazeFlood() and mazeFloodKnown() done separately.
+ */
+static void benchFloodDual(const char *floodOp, const char *dualOp) {
+  cost_t optimistic[MAZE_CELLS];
+  cost_t pessimistic[MAZE_CELLS];
+  mazeFloodKnown(GOAL_REGION);
+  memcpy(pessimistic, cost, sizeof(pessimistic));
+  FloodQueue::removed = 0;
+  mazeFlood(GOAL_REGION);
+  long dequeued = FloodQueue::removed;
+  memcpy(optimistic, cost, sizeof(optimistic));
+  addResult(floodOp, timeOperation(opFloodRegion), dequeued, -1, -1);
+
+  FloodQueue::removed = 0;
+  mazeFloodDual(GOAL_REGION);
+  dequeued = FloodQueue::removed;
+  if (memcmp(optimistic, cost, sizeof(optimistic)) != 0 || memcmp(pessimistic, costKnown, sizeof(pessimistic)) != 0) {
+    fprintf(stderr, "%s: the dual flood does not match the separate floods\n", currentMaze->name);
+    routeFailures++;
+  }
+  addResult(dualOp, timeOperation(opFloodDual), dequeued, -1, -1);
+}
+
+static void benchMaze(const Maze &maze) {
+  currentMaze = &maze;
+  loadWalls(maze.walls);
+  contestRules = followsContestRules();
+
+  FloodQueue::removed = 0;
+  mazeFlood(GOAL);
+  long dequeued = FloodQueue::removed;
+  addResult("flood", timeOperation(opFlood), dequeued, -1, -1);
+
+  FloodQueue::removed = 0;
+  mazeFlood(GOAL_REGION);
+  dequeued = FloodQueue::removed;
+  addResult("flood_region", timeOperation(opFloodRegion), dequeued, -1, -1);
+
+  FloodQueue::removed = 0;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    mazeFloodTo(GOAL_REGION, i);
+  }
+  dequeued = FloodQueue::removed / MAZE_CELLS;
+  addResult("flood_to", timeOperation(opFloodTo), dequeued, -1, -1);
+
+  checkRoutes();
+  FloodQueue::removed = 0;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    unsigned char heading;
+    pathRoute(i, GOAL_REGION, false, heading);
+  }
+  dequeued = FloodQueue::removed / MAZE_CELLS;
+  addResult("route", timeOperation(opRoute), dequeued, -1, -1);
+
+  FloodQueue::removed = 0;
+  opRouteHome();
+  dequeued = FloodQueue::removed;
+  addResult("route_home", timeOperation(opRouteHome), dequeued, pathCells(path), -1);
+
+  addResult("flood_bits", timeOperation(opFloodBits), -1, -1, -1);
+
+  mazeFlood(GOAL_REGION);
+  addResult("direction", timeOperation(opDirections) / MAZE_CELLS, -1, -1, -1);
+
+  pathGenerate(0);
+  int cells = pathCells(path);
+  addResult("path_generate", timeOperation(opPathGenerate), -1, cells, -1);
+
+  strcpy(savedPath, path);
+  addResult("run_plan", timeOperation(opRunPlan), -1, cells, -1);
+
+  plannerRemoved = 0;
+  plannerFlood(GOAL_REGION, RUN_SMOOTH);
+  dequeued = plannerRemoved;
+  addResult("planner_flood", timeOperation(opPlannerFlood), dequeued, -1, -1);
+
+  plannerPathGenerate(0);
+  addResult("planner_path", timeOperation(opPlannerPath), -1, pathCells(path), -1);
+
+  runStyle = RUN_SMOOTH;
+  opRun();
+  double simMs = simulatorTime * 1000;
+  addResult("run_smooth", timeOperation(opRun), -1, pathCells(path), simMs);
+
+  runStyle = RUN_INPLACE;
+  plannerFlood(GOAL_REGION, RUN_INPLACE);
+  plannerPathGenerate(0);
+  opRun();
+  simMs = simulatorTime * 1000;
+  addResult("run_inplace", timeOperation(opRun), -1, pathCells(path), simMs);
+
+  plannerRemoved = 0;
+  plannerFlood(GOAL_REGION, RUN_DIAGONAL);
+  dequeued = plannerRemoved;
+  addResult("planner_diagonal", timeOperation(opPlannerDiagonal), dequeued, -1, -1);
+
+  runStyle = RUN_DIAGONAL;
+  plannerPathGenerate(0);
+  if (!pathReachesGoal()) {
+    fprintf(stderr, "%s: the diagonal path does not reach the goal\n", maze.name);
+    routeFailures++;
+  }
+  opRun();
+  simMs = simulatorTime * 1000;
+  addResult("run_diagonal", timeOperation(opRun), -1, pathCells(path), simMs);
+
+  // the same runs with jerk limited straights
+  mouse.scurveRuns = true;
+  runStyle = RUN_SMOOTH;
+  plannerFlood(GOAL_REGION, RUN_SMOOTH);
+  plannerPathGenerate(0);
+  opRun();
+  simMs = simulatorTime * 1000;
+  addResult("scurve_smooth", timeOperation(opRun), -1, pathCells(path), simMs);
+
+  runStyle = RUN_DIAGONAL;
+  plannerFlood(GOAL_REGION, RUN_DIAGONAL);
+  plannerPathGenerate(0);
+  opRun();
+  simMs = simulatorTime * 1000;
+  addResult("scurve_diagonal", timeOperation(opRun), -1, pathCells(path), simMs);
+  mouse.scurveRuns = false;
+
+  checkPlanCache();
+  loadWalls(maze.walls);
+
+  FloodQueue::removed = 0;
+  opSearch();
+  dequeued = FloodQueue::removed;
+  addResult("search", timeOperation(opSearch), dequeued, searchSteps, -1);
+
+  FloodQueue::removed = 0;
+  opSearchRound();
+  dequeued = FloodQueue::removed;
+  checkSpeedCuts("search_round");
+  int searchCells = simulatorCells;
+  simMs = simulatorTime * 1000;
+  int pruned = mazePrunedCount;
+  addResult("search_round", timeOperation(opSearchRound), dequeued, searchCells, simMs, pruned);
+  benchFloodDual("flood_searched", "dual_searched");
+
+  FloodQueue::removed = 0;
+  opSearchSmooth();
+  dequeued = FloodQueue::removed;
+  checkSpeedCuts("search_smooth");
+  searchCells = simulatorCells;
+  simMs = simulatorTime * 1000;
+  pruned = mazePrunedCount;
+  addResult("search_smooth", timeOperation(opSearchSmooth), dequeued, searchCells, simMs, pruned);
+
+  FloodQueue::removed = 0;
+  opSearchProven();
+  dequeued = FloodQueue::removed;
+  checkSpeedCuts("search_proven");
+  searchCells = simulatorCells;
+  simMs = simulatorTime * 1000;
+  pruned = mazePrunedCount;
+  // the proven route must be as short as the true one
+  if (shortestRoute(NULL, true) != shortestRoute(maze.walls, false)) {
+    fprintf(stderr, "%s: the proven route is not the shortest\n", maze.name);
+    routeFailures++;
+  }
+  addResult("search_proven", timeOperation(opSearchProven), dequeued, searchCells, simMs, pruned);
+  benchFloodDual("flood_proven", "dual_proven");
+
+  FloodQueue::removed = 0;
+  opSearchExplore();
+  dequeued = FloodQueue::removed;
+  checkSpeedCuts("search_explore");
+  searchCells = simulatorCells;
+  simMs = simulatorTime * 1000;
+  pruned = mazePrunedCount;
+  checkSpeedRunPaths();
+  if (shortestRoute(NULL, true) != shortestRoute(maze.walls, false)) {
+    fprintf(stderr, "%s: the explored route is not the shortest\n", maze.name);
+    routeFailures++;
+  }
+  addResult("search_explore", timeOperation(opSearchExplore), dequeued, searchCells, simMs, pruned);
+
+  // the same search with the straights through visited cells at speed
+  FloodQueue::removed = 0;
+  opSearchKnown();
+  dequeued = FloodQueue::removed;
+  checkSpeedCuts("search_known");
+  searchCells = simulatorCells;
+  simMs = simulatorTime * 1000;
+  pruned = mazePrunedCount;
+  if (shortestRoute(NULL, true) != shortestRoute(maze.walls, false)) {
+    fprintf(stderr, "%s: the route explored at speed is not the shortest\n", maze.name);
+    routeFailures++;
+  }
+  addResult("search_known", timeOperation(opSearchKnown), dequeued, searchCells, simMs, pruned);
+  loadWalls(maze.walls);
+}
+
+static Maze *newMaze(const char *name) {
+  if (mazeCount >= MAX_MAZES) {
+    fprintf(stderr, "too many mazes\n");
+    exit(2);
+  }
+  Maze *maze = &corpus[mazeCount++];
+  snprintf(maze->name, sizeof(maze->name), "%s", name);
+  return maze;
+}
+
+static void addSample(const char *name, const unsigned char *testMaze) {
+  Maze *maze = newMaze(name);
+  mazeInit(testMaze);
+  memcpy(maze->walls, walls, MAZE_CELLS);
+}
+
+static void addFile(const char *fileName) {
+  FILE *file = fopen(fileName, "rb");
+  if (!file) {
+    perror(fileName);
+    exit(2);
+  }
+  const char *extension = strrchr(fileName, '.');
+  bool binary = extension && strcmp(extension, ".maz") == 0;
+  mazeFileBegin(binary ? MAZE_FILE_BINARY : MAZE_FILE_TEXT);
+  char chunk[64];
+  size_t count;
+  while (!mazeFileComplete() && (count = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    mazeFileRead(chunk, count);
+  }
+  fclose(file);
+  if (!mazeFileComplete()) {
+    fprintf(stderr, "%s: not a complete %d x %d maze\n", fileName, MAZE_WIDTH, MAZE_HEIGHT);
+    exit(2);
+  }
+  const char *name = strrchr(fileName, '/');
+  name = name ? name + 1 : fileName;
+  Maze *maze = newMaze(name);
+  memcpy(maze->walls, walls, MAZE_CELLS);
+}
+
+/***
+ * A seeded random maze in the contest style. A perfect maze is carved by
+ * a depth first walk and then some walls are knocked out to make loops.
+ * The four goal cells are opened up and the start cell only opens north.
+ * Then the maze is made legal: the goal keeps a single entrance and every
+ * post has at least one wall, so walls can be inferred from the rules.
+ * The generator is local so the mazes are the same on every host.
+ */
+static unsigned long randomState;
+
+static int randomNumber(int limit) {
+  randomState = randomState * 1103515245UL + 12345UL;
+  return (int)((randomState >> 16) & 0x7fff) % limit;
+}
+
+static void addRandom(int seed) {
+  char name[32];
+  snprintf(name, sizeof(name), "random-%d", seed);
+  Maze *maze = newMaze(name);
+  randomState = seed;
+  mazeInit(NULL);
+  for (int cell = 0; cell < MAZE_CELLS; cell++) {
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      mazeSetWall(cell, direction);
+    }
+  }
+  static cell_t stack[MAZE_CELLS];
+  static bool seen[MAZE_CELLS];
+  memset(seen, 0, sizeof(seen));
+  int top = 0;
+  stack[top++] = 0;
+  seen[0] = true;
+  while (top > 0) {
+    cell_t here = stack[top - 1];
+    int row = here % MAZE_HEIGHT;
+    int col = here / MAZE_HEIGHT;
+    unsigned char choices[4];
+    int count = 0;
+    if (row < MAZE_HEIGHT - 1 && !seen[cellNorth(here)]) {
+      choices[count++] = NORTH;
+    }
+    if (col < MAZE_WIDTH - 1 && !seen[cellEast(here)]) {
+      choices[count++] = EAST;
+    }
+    if (row > 0 && !seen[cellSouth(here)]) {
+      choices[count++] = SOUTH;
+    }
+    if (col > 0 && !seen[cellWest(here)]) {
+      choices[count++] = WEST;
+    }
+    if (count == 0) {
+      top--;
+      continue;
+    }
+    unsigned char direction = choices[randomNumber(count)];
+    cell_t next = neighbour(here, direction);
+    mazeClearWall(here, direction);
+    seen[next] = true;
+    stack[top++] = next;
+  }
+  for (int i = 0; i < MAZE_CELLS / 10; i++) {
+    cell_t cell = randomNumber(MAZE_CELLS);
+    unsigned char direction = randomNumber(2);  // NORTH or EAST
+    int row = cell % MAZE_HEIGHT;
+    int col = cell / MAZE_HEIGHT;
+    if ((direction == NORTH && row < MAZE_HEIGHT - 1) || (direction == EAST && col < MAZE_WIDTH - 1)) {
+      mazeClearWall(cell, direction);
+    }
+  }
+  mazeClearWall(GOAL, NORTH);
+  mazeClearWall(GOAL, EAST);
+  mazeClearWall(cellNorth(GOAL), EAST);
+  mazeClearWall(cellEast(GOAL), NORTH);
+  mazeSetWall(0, EAST);
+  mazeClearWall(0, NORTH);
+  // keep the way into the goal nearest the start and close the rest. The
+  // others may be the only way to the start from the kept one
+  mazeFlood(0);
+  int entrance = -1;
+  for (int i = 0; i < 8; i++) {
+    if (hasExit(goalCells[i], goalSides[i])) {
+      cell_t outside = neighbour(goalCells[i], goalSides[i]);
+      if (entrance < 0 || cost[outside] < cost[neighbour(goalCells[entrance], goalSides[entrance])]) {
+        entrance = i;
+      }
+    }
+  }
+  for (int i = 0; i < 8; i++) {
+    if (i != entrance && hasExit(goalCells[i], goalSides[i])) {
+      mazeSetWall(goalCells[i], goalSides[i]);
+    }
+  }
+  // give every post a wall. One wall at a bare post cannot cut the maze in
+  // two. The posts around the goal all have one now there is one entrance
+  for (int col = 1; col < MAZE_WIDTH; col++) {
+    for (int row = 1; row < MAZE_HEIGHT; row++) {
+      cell_t cell = row + MAZE_HEIGHT * col;
+      if (cell != GOAL + MAZE_HEIGHT + 1 && !postHasWall(cell)) {
+        mazeSetWall(cell, randomNumber(2) ? WEST : SOUTH);
+      }
+    }
+  }
+  memcpy(maze->walls, walls, MAZE_CELLS);
+}
+
+/***
+ * Compare the results with a CSV file from an earlier run and report any
+ * regressions on stderr. Returns the number found.
+ */
+static int compareResults(const char *fileName, double tolerance) {
+  FILE *file = fopen(fileName, "r");
+  if (!file) {
+    perror(fileName);
+    exit(2);
+  }
+  int regressions = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    Result old;
+    old.simMs = -1;
+    if (sscanf(line, "%63[^,],%31[^,],%lf,%ld,%d,%lf", old.maze, old.op, &old.nsPerOp, &old.dequeued, &old.pathLength, &old.simMs) < 5) {
+      continue;
+    }
+    for (int i = 0; i < resultCount; i++) {
+      const Result &r = results[i];
+      if (strcmp(r.maze, old.maze) != 0 || strcmp(r.op, old.op) != 0) {
+        continue;
+      }
+      if (r.dequeued != old.dequeued || r.pathLength != old.pathLength) {
+        fprintf(stderr, "%s %s: dequeued %ld was %ld, path_length %d was %d\n",
+                r.maze, r.op, r.dequeued, old.dequeued, r.pathLength, old.pathLength);
+        regressions++;
+      }
+      if (old.simMs >= 0 && r.simMs > old.simMs + 0.05) {
+        fprintf(stderr, "%s %s: simulated %.1fms was %.1fms\n", r.maze, r.op, r.simMs, old.simMs);
+        regressions++;
+      }
+      if (r.nsPerOp > old.nsPerOp * (1 + tolerance / 100)) {
+        fprintf(stderr, "%s %s: %.1fns was %.1fns\n", r.maze, r.op, r.nsPerOp, old.nsPerOp);
+        regressions++;
+      }
+    }
+  }
+  fclose(file);
+  return regressions;
+}
+
+/***
+ * The step for entry n worked out in long double rather than with the
+ * integer square roots the compiler uses for the tables. At the default
+ * acceleration, the entries of the table typed in in 2016 are used instead.
+ */
+static unsigned int referenceStep(long acceleration, int n) {
+  if (acceleration == TABLE_ACCELERATION && n < (int)(sizeof(accTable2016) / sizeof(accTable2016[0]))) {
+    return accTable2016[n];
+  }
+  if (n == 0) {
+    return 65535;
+  }
+  return (unsigned int)floorl(65536 * (sqrtl(n + 1.0L) - sqrtl(n)));
+}
+
+static unsigned int referenceCount(long acceleration, int n) {
+  unsigned long countZero = (unsigned long)floorl(F_COUNTER * sqrtl(2.0L / acceleration));
+  return (unsigned int)((referenceStep(acceleration, n) * countZero) >> 16);
+}
+
+template<long ACCELERATION, int END>
+static void checkAccTable(const char *name) {
+  for (int n = 0; n <= END; n++) {
+    unsigned int count = AccelerationTable<ACCELERATION, END>::interval(n);
+    if (count != referenceCount(ACCELERATION, n)) {
+      fprintf(stderr, "%s: entry %d is %u and should be %u\n", name, n, count, referenceCount(ACCELERATION, n));
+      routeFailures++;
+      return;
+    }
+  }
+}
+
+/***
+ * The generated tables must match the reference bit for bit. The default
+ * table must also give exactly the counts the 2016 code worked out from
+ * its typed constants, with the first count found in float arithmetic.
+ */
+static void checkAccTables() {
+  checkAccTable<TABLE_ACCELERATION, SPEED_TABLE_END>("acctable");
+  checkAccTable<ACCELERATION_STEPS(SCURVE_ACCELERATION), SPEED_TABLE_END>("acctable scurve");
+  checkAccTable<2000L, 4094>("acctable 4095 entries");
+  const long countZero = (F_COUNTER * sqrtf(2)) / sqrtf((float)TABLE_ACCELERATION);
+  for (int n = 0; n <= SPEED_TABLE_END; n++) {
+    unsigned int typed = accTable2016[n];
+    if (accStep2016(n) != typed) {
+      fprintf(stderr, "acctable: entry %d is %u and was %u in 2016\n", n, accStep2016(n), typed);
+      routeFailures++;
+      return;
+    }
+    if (accTable(n) != (typed * countZero) >> 16) {
+      fprintf(stderr, "acctable: entry %d counts %u and counted %ld in 2016\n", n, accTable(n), (typed * countZero) >> 16);
+      routeFailures++;
+      return;
+    }
+  }
+}
+
+/***
+ * The braking steps the motor interrupts count on and off must always be
+ * the ones profileSteps() works out afresh. The speed change is walked up
+ * and down in the small steps the motors make and the odd large jump.
+ */
+static void checkProfileBraking() {
+  const MotionProfile profiles[] = {PROFILE_TRAPEZOID, PROFILE_SCURVE, {512, 0}, {300, 7}};
+  for (unsigned char i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+    const MotionProfile &profile = profiles[i];
+    ProfileBraking braking;
+    int change = 0;
+    profileBrakingStart(braking, change, profile);
+    srand(i + 1);
+    for (int n = 0; n < 20000; n++) {
+      change += (rand() % 50 == 0) ? rand() % 201 - 100 : rand() % 7 - 3;
+      change = constrain(change, -SPEED_TABLE_END, SPEED_TABLE_END);
+      if (profileBraking(braking, change, profile) != profileSteps(change, profile)) {
+        fprintf(stderr, "profile %u/%u: braking for %d is %ld and should be %ld\n", profile.rate, profile.jerk,
+                change, braking.steps, profileSteps(change, profile));
+        routeFailures++;
+        return;
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  const char *baseline = NULL;
+  double tolerance = 15;
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (arg + 1 >= argc) {
+      fprintf(stderr, "usage: bench [-t ms] [-c baseline.csv] [-r percent] [maze.maz ...]\n");
+      return 2;
+    }
+    if (strcmp(argv[arg], "-t") == 0) {
+      minBatchTime = atof(argv[++arg]) * 1e6;
+    } else if (strcmp(argv[arg], "-c") == 0) {
+      baseline = argv[++arg];
+    } else if (strcmp(argv[arg], "-r") == 0) {
+      tolerance = atof(argv[++arg]);
+    } else {
+      fprintf(stderr, "unknown option %s\n", argv[arg]);
+      return 2;
+    }
+  }
+
+#if MAZE_WIDTH == 16 && MAZE_HEIGHT == 16
+  addSample("empty", emptyMaze);
+  addSample("japan2007", japan2007);
+#endif
+  for (int seed = 1; seed <= RANDOM_MAZES; seed++) {
+    addRandom(seed);
+  }
+  for (; arg < argc; arg++) {
+    addFile(argv[arg]);
+  }
+
+  checkAccTables();
+  checkProfileBraking();
+  checkLongestRoute();
+  for (int i = 0; i < mazeCount; i++) {
+    benchMaze(corpus[i]);
+  }
+
+  printf("maze,op,ns_per_op,dequeued,path_length,sim_ms,pruned\n");
+  for (int i = 0; i < resultCount; i++) {
+    const Result &r = results[i];
+    printf("%s,%s,%.1f,%ld,%d,%.1f,%d\n", r.maze, r.op, r.nsPerOp, r.dequeued, r.pathLength, r.simMs, r.pruned);
+  }
+
+  if (routeFailures > 0) {
+    return 1;
+  }
+  if (baseline && compareResults(baseline, tolerance) > 0) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,288 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/***
+ * Definitions for the parts of the sketch that the benchmark links against.
+ * The mouse.cpp search and run functions refer to the motion, sensor and
+ * user interface code. Apart from the few pieces needed to simulate a
+ * search, they do nothing here. The console output goes to stderr and
+ * the debug output is thrown away.
+ */
+
+#include "Arduino.h"
+#include "../src/hardware/hardware.h"
+#include "../motion.h"
+#include "../motors.h"
+#include "../sensors.h"
+#include "../navigator.h"
+#include "../src/hardware/ui.h"
+#include "../src/hardware/mouse.h"
+#include "../parameters.h"
+#include "../acctable.h"
+#include "../profile.h"
+#include "standin.h"
+
+volatile uint8_t SREG;
+volatile uint16_t SP;
+
+class NullStream : public Stream {
+ public:
+  virtual size_t write(uint8_t c) {
+    return 1;
+  }
+};
+
+HardwareSerial Serial1;
+NullStream nullDebug;
+HardwareSerial &console = Serial1;
+Stream &debug = nullDebug;
+
+char dirLetters[] = "NESW";
+
+volatile STEERING_MODE steeringMode;
+volatile bool wallSensorRight;
+volatile bool wallSensorLeft;
+volatile bool wallSensorFront;
+
+unsigned long millis() {
+  return 0;
+}
+
+unsigned long micros() {
+  return 0;
+}
+
+void delay(unsigned long ms) {}
+void delayMicroseconds(unsigned int us) {}
+void pinMode(int pin, int mode) {}
+void digitalWrite(int pin, int value) {}
+
+int digitalRead(int pin) {
+  return 0;
+}
+
+int analogRead(int pin) {
+  return 0;
+}
+
+const unsigned char *simulatorWalls;
+long simulatorCells;
+double simulatorTime;
+long simulatorSpeedCuts;
+
+// the time allowed for lining up on a front wall
+#define SIMULATOR_ADJUST_TIME 0.1
+
+static long simSteps;	// the sum of the steps of both motors
+static int simSpeed;	// the speed index of both motors
+static int simSpeedTarget;
+static MotionProfile simProfile = PROFILE_TRAPEZOID;
+static ProfileRamp simRamp;
+
+/***
+ * One step of each motor. The speed index moves towards the target
+ * following the profile as it does in the motor interrupts.
+ */
+static void simStep() {
+  simSpeed = profileStep(simSpeed, simSpeedTarget, simProfile, simRamp);
+  if (simSpeed < 1) {
+    simSpeed = 1;
+  }
+  simulatorTime += accTable(simSpeed) / (double)F_MOTOR_TIMER;
+  simSteps += 2;
+}
+
+static void simRunTo(long steps) {
+  while (simSteps < steps) {
+    simStep();
+  }
+}
+
+// as motorsMove() in motors.cpp, to a step count since the last reset
+static void simMoveTo(long steps, int maxSpeed, int exitSpeed) {
+  simSpeedTarget = maxSpeed;
+  while (simSteps < steps && steps - simSteps >= 2 * profileSteps(simSpeed - exitSpeed, simProfile)) {
+    simStep();
+  }
+  simSpeedTarget = exitSpeed > 0 ? exitSpeed : 1;
+  simRunTo(steps);
+  // the last step may still be coming down to the exit speed
+  if (simSpeed > simSpeedTarget + 1) {
+    simulatorSpeedCuts++;
+  }
+  simSpeed = exitSpeed;
+  simSpeedTarget = exitSpeed;
+}
+
+// as move() in motion.cpp
+static void simMove(long steps, int maxSpeed, int exitSpeed, const MotionProfile &profile = PROFILE_TRAPEZOID) {
+  if (steps < 0) {
+    steps = -steps;
+  }
+  simSteps = 0;
+  simProfile = profile;
+  simMoveTo(steps, maxSpeed, exitSpeed);
+}
+
+/***
+ * The mouse is about to leave the centre of its cell. By the time it
+ * reaches the next cell boundary, the sensors will see the walls of the
+ * cell ahead.
+ */
+void startForward(int maxSpeed) {
+  simSteps = 0;
+  simProfile = PROFILE_TRAPEZOID;
+  simSpeedTarget = maxSpeed;
+  if (!simulatorWalls) {
+    return;
+  }
+  cell_t next = neighbour(mouse.location, mouse.heading);
+  unsigned char nextWalls = simulatorWalls[next];
+  wallSensorFront = nextWalls & (1 << mouse.heading);
+  wallSensorRight = nextWalls & (1 << DtoR[mouse.heading]);
+  wallSensorLeft = nextWalls & (1 << DtoL[mouse.heading]);
+  simulatorCells++;
+}
+
+void forward(long steps, int maxSpeed, int exitSpeed, const MotionProfile &profile) {
+  // a search only moves whole cells this way on a straight through
+  // cells it has already mapped
+  if (simulatorWalls) {
+    simulatorCells += steps / MM(180);
+  }
+  simMove(steps, maxSpeed, exitSpeed, profile);
+}
+
+void turnIP180() {
+  simMove(DEG(180), SPEEDMAX_SPIN_TURN, 0);
+  mouse.heading = DtoB[mouse.heading];
+}
+
+void turnIP90R() {
+  simMove(DEG(90), SPEEDMAX_SPIN_TURN, 0);
+  mouse.heading = DtoR[mouse.heading];
+}
+
+void turnIP90L() {
+  simMove(DEG(90), SPEEDMAX_SPIN_TURN, 0);
+  mouse.heading = DtoL[mouse.heading];
+}
+
+static void simTurnSmooth(int phase2) {
+  simSteps = 0;
+  simProfile = PROFILE_TRAPEZOID;
+  simSpeed = SPEEDMAX_SMOOTH_TURN;
+  simSpeedTarget = SPEEDMAX_SMOOTH_TURN;
+  simRunTo(2 * SMOOTH_TURN_PHASE1 + phase2);
+}
+
+void turnSS90L() {
+  simTurnSmooth(SMOOTH_TURN_PHASE2);
+  mouse.heading = DtoL[mouse.heading];
+}
+
+void turnSS90R() {
+  simTurnSmooth(SMOOTH_TURN_PHASE2);
+  mouse.heading = DtoR[mouse.heading];
+}
+
+// as in motion.cpp
+static void turnEighths(int eighths) {
+  int direction = (mouse.heading * 2 + (mouse.diagonal ? 1 : 0) + eighths) & 0x07;
+  mouse.heading = direction >> 1;
+  mouse.diagonal = (direction & 1) != 0;
+}
+
+void turnSS45L() {
+  simTurnSmooth(SMOOTH_TURN_45_PHASE2);
+  turnEighths(-1);
+}
+
+void turnSS45R() {
+  simTurnSmooth(SMOOTH_TURN_45_PHASE2);
+  turnEighths(1);
+}
+
+void turnSS135L() {
+  simTurnSmooth(SMOOTH_TURN_135_PHASE2);
+  turnEighths(-3);
+}
+
+void turnSS135R() {
+  simTurnSmooth(SMOOTH_TURN_135_PHASE2);
+  turnEighths(3);
+}
+
+void motorsEnable() {}
+void motorsDisable() {}
+
+void motorsStopAt(long distance) {
+  simMoveTo(distance, simSpeedTarget, 0);
+}
+
+void motorsMoveTo(long target, int maxSpeed, int exitSpeed) {
+  // as for forward(), a search only crosses whole cells this way on a
+  // straight through cells it has already mapped
+  if (simulatorWalls) {
+    simulatorCells += (target - simSteps) / MM(180);
+  }
+  simMoveTo(target, maxSpeed, exitSpeed);
+}
+
+// both motors run at simSpeed so the braking steps are doubled
+bool motorsCanSlowTo(long target, int speed) {
+  return target - simSteps >= 2 * profileSteps(simSpeed - speed, simProfile);
+}
+
+void motorsWaitUntil(long distance) {
+  simRunTo(distance);
+}
+
+// the simulated moves are made as they are queued so there is nothing to wait for
+bool motionQueued;
+
+void motorsWaitForMove() {}
+
+void sensorsInit() {}
+void adjustFrontDistance() {
+  if (mouse.frontWall) {
+    simulatorTime += SIMULATOR_ADJUST_TIME / 2;
+  }
+}
+
+void adjustFrontAngle() {
+  if (mouse.frontWall) {
+    simulatorTime += SIMULATOR_ADJUST_TIME / 2;
+  }
+}
+void panic() {}
+
+int waitForStart() {
+  return 0;
+}
+
+bool buttonPressed() {
+  return false;
+}
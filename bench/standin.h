@@ -0,0 +1,51 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#ifndef STANDIN_H
+#define STANDIN_H
+
+/***
+ * A very simple simulation of the mouse so that the real search code in
+ * mouse.cpp can be run on the host. Set simulatorWalls to the true maze
+ * and each time the mouse sets off into the next cell, the wall sensors
+ * are set from the walls of that cell. The turns change the heading as
+ * the real ones do. With simulatorWalls NULL, the sensors are left alone.
+ *
+ * The time for each move is added to simulatorTime. The motors are
+ * stepped through the acceleration table just as the motor interrupts
+ * would do it. Smooth turns are taken at a steady SPEEDMAX_SMOOTH_TURN
+ * and lining up on a front wall is given a fixed time so those are only
+ * estimates.
+ *
+ * A move that ends going faster than its exit speed has its speed cut,
+ * as moveFinish() in motors.cpp does. A real stepper may not follow that
+ * so each one is counted in simulatorSpeedCuts.
+ */
+extern const unsigned char *simulatorWalls;
+extern long simulatorCells;   // the number of cells the mouse has entered
+extern double simulatorTime;  // seconds
+extern long simulatorSpeedCuts;
+
+#endif // STANDIN_H
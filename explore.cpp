@@ -0,0 +1,204 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#include "explore.h"
+#include "parameters.h"
+#include "src/hardware/queue.h"
+
+/***
+ * Exploring a cell is only useful while some of its walls are unknown
+ * and it is not in a dead end.
+ */
+static bool worthExploring(cell_t cell) {
+  if ((walls[cell] & VISITED) || mazeCellPruned(cell)) {
+    return false;
+  }
+  for (unsigned char direction = 0; direction < 4; direction++) {
+    if (!mazeWallKnown(cell, direction)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// the last choice and the state of the map when it was made
+static cell_t chosenFrom;
+static cell_t chosenTarget;
+static bool chosenValid = false;
+static unsigned int chosenGeneration;
+static unsigned int chosenLearned;
+
+/***
+ * The last choice still stands if the map has not changed, the target
+ * is still worth a visit and the mouse has at most moved one cell
+ * towards it. Every other cell has moved at most one cell nearer while
+ * the target has come one cell nearer, so it still scores best. A
+ * cell visited since then only drops out of the running.
+ */
+static bool chosenStillBest(cell_t from) {
+  if (!chosenValid || mazeGeneration != chosenGeneration || mazeLearned != chosenLearned) {
+    return false;
+  }
+  if (!worthExploring(chosenTarget)) {
+    return false;
+  }
+  if (from == chosenFrom) {
+    return true;
+  }
+  for (unsigned char direction = 0; direction < 4; direction++) {
+    if (hasExit(chosenFrom, direction) && neighbour(chosenFrom, direction) == from) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/***
+ * The cell worth exploring that lies on the shortest possible route
+ * through the unexplored cells, ignoring how far away it is. Used by
+ * exploreChooseTarget() when it has to give up before finding a cell.
+ */
+static bool bestGain(unsigned int known, cell_t &target) {
+  unsigned int best = known;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    if (cost[i] != MAX_COST && costKnown[i] != MAX_COST && worthExploring(i)) {
+      unsigned int route = cost[i] + costKnown[i];
+      if (route < best) {
+        best = route;
+        target = i;
+      }
+    }
+  }
+  return best < known;
+}
+
+/***
+ * Pick the next cell for the search to explore.
+ *
+ * With unknown walls treated as open, the cost of a cell from the goal
+ * plus its cost from the start is the length of the shortest route that
+ * could pass through it. The amount by which that is shorter than the
+ * known route is what exploring the cell might gain. When there is no
+ * known route yet, the gain is measured from MAZE_CELLS instead, which
+ * keeps the same order.
+ *
+ * Each cell of gain is worth EXPLORE_GAIN_WEIGHT cells of travel. The
+ * cells are examined in order of their distance from the mouse so the
+ * search can stop once no cell further away could score any better.
+ * Of two cells with the same score, the nearer one is chosen.
+ *
+ * Should the queue fill up, the cells are examined no further and the
+ * best one found so far is chosen. If there is none yet, the cell with
+ * the most to gain is chosen wherever it is. See bestGain().
+ *
+ * Choosing floods the maze from both ends and then searches outwards
+ * from the mouse, about 15ms in all on the mouse, so it is only done
+ * again once the map changes. While the mouse runs through cells
+ * it has already mapped, the last choice is kept. See chosenStillBest().
+ *
+ * Uses cost[] and costKnown[] as working space when it floods. Their
+ * contents are of no use afterwards.
+ *
+ * Returns false, leaving target unchanged, if there is nothing left to
+ * gain. Either the shortest route is proven or there is no route at all.
+ *
+ * @param from   - the cell the mouse is in
+ * @param target - set to the chosen cell
+ */
+bool exploreChooseTarget(cell_t from, cell_t &target) {
+  if (chosenStillBest(from)) {
+    chosenFrom = from;
+    target = chosenTarget;
+    return true;
+  }
+  chosenValid = false;
+  mazeFloodDual(GOAL_REGION);
+  unsigned int shortest = cost[0];
+  unsigned int known = costKnown[0];
+  if (shortest == MAX_COST || known == shortest) {
+    return false;
+  }
+  if (known == MAX_COST) {
+    known = MAZE_CELLS;
+  }
+  mazeFloodSecond(0);
+  int bestPossible = EXPLORE_GAIN_WEIGHT * (int)(known - shortest);
+  int bestScore = 0;
+  bool found = false;
+  unsigned char seen[(MAZE_CELLS + 7) / 8] = {0};
+  Queue<cell_t, FLOOD_QUEUE_SIZE> queue;
+  queue.add(from);
+  seen[from / 8] |= 1 << (from % 8);
+  int distance = 0;
+  int layer = 1;	// cells left in the queue at this distance
+  bool cutShort = false;
+  while (queue.size() > 0 && !cutShort) {
+    if (found && bestScore >= bestPossible - distance) {
+      break;
+    }
+    cell_t here = queue.head();
+    if (cost[here] != MAX_COST && costKnown[here] != MAX_COST && worthExploring(here)) {
+      unsigned int route = cost[here] + costKnown[here];
+      if (route < known) {
+        int score = EXPLORE_GAIN_WEIGHT * (int)(known - route) - distance;
+        if (!found || score > bestScore) {
+          found = true;
+          bestScore = score;
+          target = here;
+        }
+      }
+    }
+    // there is no need to go into a dead end, only out of one
+    bool inDeadEnd = mazeCellPruned(here);
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (hasExit(here, direction)) {
+        cell_t nextCell = neighbour(here, direction);
+        if ((seen[nextCell / 8] & (1 << (nextCell % 8))) == 0 && (inDeadEnd || !mazeCellPruned(nextCell))) {
+          if (queue.full()) {
+            cutShort = true;
+            break;
+          }
+          seen[nextCell / 8] |= 1 << (nextCell % 8);
+          queue.add(nextCell);
+        }
+      }
+    }
+    if (--layer == 0) {
+      distance++;
+      layer = queue.size();
+    }
+  }
+  if (!found && cutShort) {
+    found = bestGain(known, target);
+  }
+  if (found) {
+    chosenValid = true;
+    chosenFrom = from;
+    chosenTarget = target;
+    chosenGeneration = mazeGeneration;
+    chosenLearned = mazeLearned;
+  }
+  return found;
+}
@@ -28,21 +28,259 @@
 #include "avr/pgmspace.h"
 #include "src/hardware/queue.h"
 
-unsigned char cost[256];
-unsigned char walls[256] __attribute__((section(".noinit")));	// the maze walls are preserved after a reset
+// the SIMD layer expansion only handles the classic 16 x 16 bitboards
+#if MAZE_WIDTH == 16 && MAZE_HEIGHT == 16
+#if defined(__AVX2__)
+#define FLOOD_AVX2
+#elif defined(__SSE2__)
+#define FLOOD_SSE2
+#endif
+#endif
+#if defined(FLOOD_AVX2) || defined(FLOOD_SSE2)
+#include <immintrin.h>
+#endif
 
+MazeScratch mazeScratch;
+unsigned char walls[MAZE_CELLS] __attribute__((section(".noinit")));	// the maze walls are preserved after a reset
+
+// bitboard copies of walls[]. Entry r has bit c set if cell (c,r) has a wall
+row_t rowNorthWalls[MAZE_HEIGHT];
+row_t rowEastWalls[MAZE_HEIGHT];
+
+// the walls the mouse has seen, whether present or not, in the same layout
+// as the wall bitboards. The border walls are always known.
+row_t rowNorthKnown[MAZE_HEIGHT];
+row_t rowEastKnown[MAZE_HEIGHT];
+
+// the known walls that were worked out by mazeInferWalls() rather than seen
+row_t rowNorthInferred[MAZE_HEIGHT];
+row_t rowEastInferred[MAZE_HEIGHT];
+
+// the dead end cells, one bit for each cell in the same layout as the
+// wall bitboards. See mazeCellPruned()
+row_t rowPruned[MAZE_HEIGHT];
+int mazePrunedCount;	// the number of bits set in rowPruned[]
+
+// bumped by every change to the walls so that anything worked out from
+// the map can tell whether it is out of date. See pathPlan()
+unsigned int mazeGeneration;
+unsigned int mazeOpened;	// the value of mazeGeneration when a wall was last removed
+// bumped whenever a wall becomes known, whether or not it is there. See
+// exploreChooseTarget()
+unsigned int mazeLearned;
+
+static CellSet floodTargets(0);	// the targets used for the last full flood
+static bool floodStale = false;	// cost[] cannot be repaired by mazeFloodUpdate()
+
+
+/***
+ * Copy the north and east walls of a single cell into the bitboards.
+ * Between them, these describe every wall in the maze since the south
+ * and west walls of a cell are the north and east walls of its neighbours.
+ */
+static void mazeSyncCell(cell_t cell) {
+  int row = cell % MAZE_HEIGHT;
+  row_t mask = (row_t)1 << (cell / MAZE_HEIGHT);
+  if (walls[cell] & (1 << NORTH)) {
+    rowNorthWalls[row] |= mask;
+  } else {
+    rowNorthWalls[row] &= ~mask;
+  }
+  if (walls[cell] & (1 << EAST)) {
+    rowEastWalls[row] |= mask;
+  } else {
+    rowEastWalls[row] &= ~mask;
+  }
+}
+
+/***
+ * A pruned cell is part of a dead end. No route from the start to the
+ * goal, or from one cell outside the dead end to another, can go into
+ * it, so there is nothing to gain by exploring it.
+ *
+ * The pruning follows the walls as they are added. Dead end regions
+ * that have loops inside them are not pruned but once they are closed
+ * off completely their cells cannot be reached at all and flood to
+ * MAX_COST.
+ */
+bool mazeCellPruned(cell_t cell) {
+  return (rowPruned[cell % MAZE_HEIGHT] >> (cell / MAZE_HEIGHT)) & 1;
+}
+
+/***
+ * Prune the cell if it has become a dead end and follow the dead end
+ * back along the corridor for as long as it goes.
+ *
+ * A cell with only one way out that is not pruned can never be on a
+ * route between two other cells. Nor can one with no way out at all.
+ * Unknown walls count as open so a cell is pruned only once the walls
+ * that make it a dead end have been found. The start and the goal cells
+ * are the ends of every route and are never pruned.
+ *
+ * Pruning a cell takes a way out from its one open neighbour, which may
+ * then be a dead end in turn.
+ */
+static void pruneFrom(cell_t cell) {
+  while (!mazeCellPruned(cell) && cell != 0 && !GOAL_REGION.contains(cell)) {
+    unsigned char exits = 0;
+    cell_t next = cell;
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (hasExit(cell, direction) && !mazeCellPruned(neighbour(cell, direction))) {
+        next = neighbour(cell, direction);
+        exits++;
+      }
+    }
+    if (exits > 1) {
+      return;
+    }
+    rowPruned[cell % MAZE_HEIGHT] |= (row_t)1 << (cell / MAZE_HEIGHT);
+    mazePrunedCount++;
+    cell = next;
+  }
+}
+
+/***
+ * Work out the dead ends for the whole maze from scratch.
+ */
+static void pruneAll() {
+  for (int row = 0; row < MAZE_HEIGHT; row++) {
+    rowPruned[row] = 0;
+  }
+  mazePrunedCount = 0;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    pruneFrom(i);
+  }
+}
+
+/***
+ * walls[] is the master copy of the map. Rebuild the bitboards from it
+ * after it has been changed directly, by a copy or after a reset.
+ *
+ * The walls of a visited cell have all been seen so the known walls
+ * are rebuilt from the VISITED bits. Inferred walls stay in walls[] but
+ * are no longer marked as known.
+ *
+ * Any wall may have gone so this counts as a removal. See mazeGeneration.
+ */
+void mazeSyncBitboards() {
+  mazeGeneration++;
+  mazeOpened = mazeGeneration;
+  for (int row = 0; row < MAZE_HEIGHT; row++) {
+    rowNorthKnown[row] = 0;
+    rowEastKnown[row] = 0;
+    rowNorthInferred[row] = 0;
+    rowEastInferred[row] = 0;
+  }
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    mazeSyncCell(i);
+    if (walls[i] & VISITED) {
+      mazeMarkVisited(i);
+    }
+  }
+  pruneAll();
+}
+
+/***
+ * Set the bit for one wall in a pair of bitboards laid out as the wall
+ * bitboards. The south and west walls of a cell are stored as the north
+ * and east walls of its neighbours. There is no bit for the south and
+ * west borders.
+ */
+static void setWallBit(row_t *north, row_t *east, cell_t cell, unsigned char direction) {
+  int row = cell % MAZE_HEIGHT;
+  int col = cell / MAZE_HEIGHT;
+  switch (direction) {
+    case NORTH:
+      north[row] |= (row_t)1 << col;
+      break;
+    case EAST:
+      east[row] |= (row_t)1 << col;
+      break;
+    case SOUTH:
+      if (row > 0) {
+        north[row - 1] |= (row_t)1 << col;
+      }
+      break;
+    case WEST:
+      if (col > 0) {
+        east[row] |= (row_t)1 << (col - 1);
+      }
+      break;
+    default:; // do nothing -although this is an error
+      break;
+  }
+}
+
+/***
+ * Gather the bits for the four walls of a cell from a pair of bitboards
+ * into the same bit positions as the walls in walls[] so that they can be
+ * tested together. The south and west borders read as the given value.
+ */
+static unsigned char wallBits(const row_t *north, const row_t *east, cell_t cell, bool border) {
+  int row = cell % MAZE_HEIGHT;
+  int col = cell / MAZE_HEIGHT;
+  unsigned char bits = 0;
+  bits |= ((north[row] >> col) & 1) << NORTH;
+  bits |= ((east[row] >> col) & 1) << EAST;
+  if (row > 0 ? ((north[row - 1] >> col) & 1) : border) {
+    bits |= 1 << SOUTH;
+  }
+  if (col > 0 ? ((east[row] >> (col - 1)) & 1) : border) {
+    bits |= 1 << WEST;
+  }
+  return bits;
+}
+
+/***
+ * Record that a single wall has been seen, whether or not it is present.
+ * The border walls are always known so there is nothing to store for them.
+ *
+ * No check is made on the provided value for direction
+ */
+void mazeSetKnown(cell_t cell, unsigned char direction) {
+  if (!mazeWallKnown(cell, direction)) {
+    setWallBit(rowNorthKnown, rowEastKnown, cell, direction);
+    mazeLearned++;
+  }
+}
+
+static unsigned char knownWalls(cell_t cell) {
+  return wallBits(rowNorthKnown, rowEastKnown, cell, true);
+}
+
+bool mazeWallKnown(cell_t cell, unsigned char direction) {
+  return (knownWalls(cell) & (1 << direction)) != 0;
+}
+
+bool mazeWallInferred(cell_t cell, unsigned char direction) {
+  return (wallBits(rowNorthInferred, rowEastInferred, cell, false) & (1 << direction)) != 0;
+}
+
+/***
+ * The mouse has been in the cell and seen all four of its walls.
+ */
+void mazeMarkVisited(cell_t cell) {
+  walls[cell] |= VISITED;
+  for (unsigned char direction = 0; direction < 4; direction++) {
+    mazeSetKnown(cell, direction);
+  }
+}
 
 /***
  * Set a single wall in the maze. Each wall is set from two directions
  * so that it is consistent when seen from the neighbouring cell.
  *
  * The wall is set unconditionally regardless of whether there is
- * already a wall present
+ * already a wall present. Closing a passage can make a dead end and
+ * the cells on either side are checked. See mazeCellPruned().
+ *
+ * Only a wall that was not there counts as a change. See mazeGeneration.
  *
  * No check is made on the provided value for direction
  */
-void mazeSetWall(unsigned char cell, unsigned char direction) {
+void mazeSetWall(cell_t cell, unsigned char direction) {
   unsigned int nextCell = neighbour(cell, direction);
+  bool closing = hasExit(cell, direction);
   switch (direction) {
     case NORTH:
       walls[cell] |= (1 << NORTH);
@@ -63,6 +301,13 @@ void mazeSetWall(unsigned char cell, unsigned char direction) {
     default:; // do nothing -although this is an error
       break;
   }
+  mazeSyncCell(cell);
+  mazeSyncCell(nextCell);
+  if (closing) {
+    mazeGeneration++;
+    pruneFrom(cell);
+    pruneFrom(nextCell);
+  }
 }
 
 /***
@@ -70,12 +315,16 @@ void mazeSetWall(unsigned char cell, unsigned char direction) {
  * so that it is consistent when seen from the neighbouring cell.
  *
  * The wall is cleared unconditionally regardless of whether there is
- * already a wall present
+ * already a wall present. Opening up a dead end means the pruning
+ * is done again for the whole maze.
+ *
+ * Only a wall that was there counts as a change. See mazeGeneration.
  *
  * No check is made on the provided value for direction
  */
-void mazeClearWall(unsigned char cell, unsigned char direction) {
+void mazeClearWall(cell_t cell, unsigned char direction) {
   unsigned int nextCell = neighbour(cell, direction);
+  bool opening = hasWall(cell, direction);
   switch (direction) {
     case NORTH:
       walls[cell] &= ~(1 << NORTH);
@@ -96,6 +345,144 @@ void mazeClearWall(unsigned char cell, unsigned char direction) {
     default:; // do nothing -although this is an error
       break;
   }
+  mazeSyncCell(cell);
+  mazeSyncCell(nextCell);
+  if (opening) {
+    mazeGeneration++;
+    mazeOpened = mazeGeneration;
+  }
+  // a new opening can bring dead ends back to life
+  if (opening && (mazeCellPruned(cell) || mazeCellPruned(nextCell))) {
+    pruneAll();
+  }
+}
+
+
+/***
+ * Record a wall, or the lack of one, that has been worked out from the
+ * contest rules rather than seen. It is known from then on and marked
+ * as inferred.
+ */
+static void inferWall(cell_t cell, unsigned char direction, bool present) {
+  if (present) {
+    mazeSetWall(cell, direction);
+    floodStale = true;
+  }
+  mazeSetKnown(cell, direction);
+  setWallBit(rowNorthInferred, rowEastInferred, cell, direction);
+}
+
+/***
+ * Every post, apart from the one in the middle of the goal, has at least
+ * one wall touching it. When three of the walls at a post are known to be
+ * missing, the fourth must be there.
+ *
+ * The post is the one at the south west corner of the given column and
+ * row. Posts on the border always touch a wall so they are ignored.
+ */
+static void inferPost(int col, int row) {
+  if (col < 1 || row < 1 || col >= MAZE_WIDTH || row >= MAZE_HEIGHT) {
+    return;
+  }
+  cell_t cell = row + MAZE_HEIGHT * col;
+  if (cell == GOAL + MAZE_HEIGHT + 1) {
+    return;
+  }
+  // the walls going north, east, south and west from the post
+  const cell_t cells[4] = {cell, cell, cellSouth(cell), cellWest(cell)};
+  const unsigned char directions[4] = {WEST, SOUTH, WEST, SOUTH};
+  int unknown = -1;
+  for (int i = 0; i < 4; i++) {
+    if (!mazeWallKnown(cells[i], directions[i])) {
+      if (unknown >= 0) {
+        return;
+      }
+      unknown = i;
+    } else if (hasWall(cells[i], directions[i])) {
+      return;
+    }
+  }
+  if (unknown >= 0) {
+    inferWall(cells[unknown], directions[unknown], true);
+  }
+}
+
+/***
+ * The four goal cells have no walls between them and there is only one
+ * way in. Once the entrance is known, every other wall around the goal
+ * must be there. Once seven of those walls are known, the eighth must be
+ * the entrance.
+ */
+static void inferGoal() {
+  const cell_t inside[4] = {GOAL, GOAL, GOAL + 1, GOAL + MAZE_HEIGHT};
+  const unsigned char across[4] = {NORTH, EAST, EAST, NORTH};
+  for (int i = 0; i < 4; i++) {
+    if (!mazeWallKnown(inside[i], across[i]) && hasExit(inside[i], across[i])) {
+      inferWall(inside[i], across[i], false);
+    }
+  }
+  const cell_t cells[8] = {GOAL, GOAL + MAZE_HEIGHT, GOAL + 1, GOAL + MAZE_HEIGHT + 1,
+                           GOAL, GOAL + 1, GOAL + MAZE_HEIGHT, GOAL + MAZE_HEIGHT + 1
+                          };
+  const unsigned char directions[8] = {SOUTH, SOUTH, NORTH, NORTH, WEST, WEST, EAST, EAST};
+  int unknown = -1;
+  int unknowns = 0;
+  bool entrance = false;
+  for (int i = 0; i < 8; i++) {
+    if (!mazeWallKnown(cells[i], directions[i])) {
+      unknown = i;
+      unknowns++;
+    } else if (hasExit(cells[i], directions[i])) {
+      entrance = true;
+    }
+  }
+  if (unknowns == 0) {
+    return;
+  }
+  if (entrance) {
+    for (int i = 0; i < 8; i++) {
+      if (!mazeWallKnown(cells[i], directions[i])) {
+        inferWall(cells[i], directions[i], true);
+      }
+    }
+  } else if (unknowns == 1 && hasExit(cells[unknown], directions[unknown])) {
+    inferWall(cells[unknown], directions[unknown], false);
+    // the posts at either end of the entrance may now be settled
+    int row = cells[unknown] % MAZE_HEIGHT;
+    int col = cells[unknown] / MAZE_HEIGHT;
+    inferPost(col, row);
+    inferPost(col + 1, row);
+    inferPost(col, row + 1);
+    inferPost(col + 1, row + 1);
+  }
+}
+
+/***
+ * Contest mazes follow rules that settle some walls before the mouse has
+ * seen them. Call this once the walls of a cell have been mapped to add
+ * whatever follows from them. Inferred walls are set in walls[] and, like
+ * inferred openings, are marked as known so that the pessimistic floods,
+ * mazeRouteProven() and the exploring search treat them as seen. They are
+ * also marked as inferred. See mazeWallInferred().
+ *
+ * Only the posts at the corners of the cell can change, along with the
+ * walls around the goal. The border walls are set by mazeInit() and are
+ * always known.
+ *
+ * New walls need not be next to the cell so the next mazeFloodUpdate()
+ * will do a full flood.
+ *
+ * A maze that breaks the rules, such as the empty test maze, will have
+ * walls inferred that are not there.
+ */
+void mazeInferWalls(cell_t cell) {
+  int row = cell % MAZE_HEIGHT;
+  int col = cell / MAZE_HEIGHT;
+  inferPost(col, row);
+  inferPost(col + 1, row);
+  inferPost(col, row + 1);
+  inferPost(col + 1, row + 1);
+  inferGoal();
 }
 
 
@@ -107,45 +494,56 @@ void mazeClearWall(unsigned char cell, unsigned char direction) {
  *
  */
 void mazeInit(const unsigned char *testMaze) {
-  for (int i = 0; i < 256; i++) {
+  for (int i = 0; i < MAZE_CELLS; i++) {
     cost[i] = 0;
     walls[i] = 0;
   }
+  mazeSyncBitboards();
   if (testMaze) {
     mazeCopyWallsFromFlash(testMaze);
     return;
   }
-  for (unsigned char i = 0; i < 16; i++) {
-    mazeSetWall(i, WEST);
-    mazeSetWall(15 * 16 + i, EAST);
-    mazeSetWall(i * 16, SOUTH);
-    mazeSetWall((16 * i + 15), NORTH);
+  // one loop does all four sides. For a square maze the tests vanish
+  for (int i = 0; i < MAX_SIDE; i++) {
+    if (i < MAZE_HEIGHT) {
+      mazeSetWall(i, WEST);
+      mazeSetWall((MAZE_WIDTH - 1) * MAZE_HEIGHT + i, EAST);
+    }
+    if (i < MAZE_WIDTH) {
+      mazeSetWall(i * MAZE_HEIGHT, SOUTH);
+      mazeSetWall(i * MAZE_HEIGHT + MAZE_HEIGHT - 1, NORTH);
+    }
   }
   mazeSetWall(0, EAST);
   mazeClearWall(0, NORTH);
 }
 
-unsigned char cellNorth(unsigned char cell) {
-  unsigned char nextCell = (cell + (1));
+/***
+ * The neighbour functions wrap around the edges of the maze. For the
+ * classic maze, MAZE_CELLS is 256 and the modulus is simply the byte
+ * wraparound of the original unsigned char arithmetic.
+ */
+cell_t cellNorth(cell_t cell) {
+  cell_t nextCell = (cell + (1)) % MAZE_CELLS;
   return nextCell;
 }
 
-unsigned char cellEast(unsigned char cell) {
-  unsigned char nextCell = (cell + (16));
+cell_t cellEast(cell_t cell) {
+  cell_t nextCell = (cell + (MAZE_HEIGHT)) % MAZE_CELLS;
   return nextCell;
 }
 
-unsigned char cellSouth(unsigned char cell) {
-  unsigned char nextCell = (cell + (255));
+cell_t cellSouth(cell_t cell) {
+  cell_t nextCell = (cell + (MAZE_CELLS - 1)) % MAZE_CELLS;
   return nextCell;
 }
 
-unsigned char cellWest(unsigned char cell) {
-  unsigned char nextCell = (cell + (240));
+cell_t cellWest(cell_t cell) {
+  cell_t nextCell = (cell + (MAZE_CELLS - MAZE_HEIGHT)) % MAZE_CELLS;
   return nextCell;
 }
 
-unsigned char neighbour(unsigned char cell, unsigned char direction) {
+cell_t neighbour(cell_t cell, unsigned char direction) {
   unsigned int next;
   switch (direction) {
     case NORTH:
@@ -170,8 +568,8 @@ unsigned char neighbour(unsigned char cell, unsigned char direction) {
 /***
  * Assumes the maze has been flooded
  */
-unsigned char neighbourCost(unsigned char cell, unsigned char direction) {
-  unsigned char result = MAX_COST;
+cost_t neighbourCost(cell_t cell, unsigned char direction) {
+  cost_t result = MAX_COST;
   unsigned char wallData = walls[cell];
   switch (direction) {
     case NORTH:
@@ -203,31 +601,479 @@ unsigned char neighbourCost(unsigned char cell, unsigned char direction) {
 
 
 
+/***
+ * A passage is known to be open when the mouse has seen the wall that
+ * would close it and found that it is not there.
+ */
+bool hasKnownExit(cell_t cell, unsigned char direction) {
+  if (!hasExit(cell, direction)) {
+    return false;
+  }
+  return (walls[cell] & VISITED) || mazeWallKnown(cell, direction);
+}
+
+/***
+ * The common body of the cell counting floods. With KNOWN_ONLY set, only
+ * passages the mouse has seen are used so that unknown walls count as
+ * closed rather than open. The costs go into cost[] or, with SECOND set,
+ * into costKnown[] for mazeFloodSecond().
+ *
+ * Unless stopAt is -1, the flood stops as soon as that cell has its
+ * cost. See mazeFloodTo().
+ */
+template <bool KNOWN_ONLY, bool SECOND>
+static void floodCells(const CellSet &targets, int stopAt = -1) {
+  cost_t *costs = SECOND ? costKnown : cost;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    costs[i] = MAX_COST;
+  }
+  Queue<cell_t, FLOOD_QUEUE_SIZE> queue;
+  for (unsigned char i = 0; i < targets.count; i++) {
+    costs[targets.cells[i]] = 0;
+    queue.add(targets.cells[i]);
+  }
+  if (stopAt >= 0 && targets.contains(stopAt)) {
+    return;
+  }
+  while (queue.size() > 0) {
+    cell_t here = queue.head();
+    unsigned int newCost = costs[here] + 1;
+
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (KNOWN_ONLY ? hasKnownExit(here, direction) : hasExit(here,  direction)) {
+        unsigned int nextCell = neighbour(here, direction);
+        if (costs[nextCell] > newCost) {
+          costs[nextCell] = newCost;
+          if ((int)nextCell == stopAt) {
+            return;
+          }
+          queue.add(nextCell);
+        }
+      }
+    }
+  }
+}
+
+/***
+ * cost[] shares its memory with the planner. After a plannerFlood() the
+ * costs are gone so the next mazeFloodUpdate() has to flood afresh.
+ */
+void mazeCostsLost() {
+  floodStale = true;
+}
+
 /***
  * Very simple cell counting flood fills cost array with the
- * manhattan distance from every cell to the target.
+ * manhattan distance from every cell to the nearest target.
  *
  * Although the queue looks complicated, this is a fast flood that
  * examines each accessible cell exactly once. Consequently, it runs
  * in fairly constant time, taking 5.3ms when there are no interrupts.
  *
- * @param target - the cell from which all distances are calculated
+ * All the targets start at a cost of zero so flooding to the four goal
+ * cells together takes no longer than flooding to one of them.
+ *
+ * @param targets - the cells from which all distances are calculated
+ */
+void mazeFlood(const CellSet &targets) {
+  floodTargets = targets;
+  floodStale = false;
+  floodCells<false, false>(targets);
+}
+
+/***
+ * The pessimistic version of mazeFlood(). Every wall that has not been
+ * seen is treated as present so the costs are the lengths of routes
+ * the mouse knows to exist. Cells that cannot be reached through known
+ * passages are left at MAX_COST.
+ *
+ * The costs are not suitable for mazeFloodUpdate().
+ *
+ * @param targets - the cells from which all distances are calculated
+ */
+void mazeFloodKnown(const CellSet &targets) {
+  floodTargets = targets;
+  floodStale = true;
+  floodCells<true, false>(targets);
+}
+
+/***
+ * Flood as mazeFlood(), or as mazeFloodKnown() with knownOnly set, but
+ * stop as soon as the given cell has its cost. That is all a search
+ * needs to decide its next move.
+ *
+ * The flood works outwards from the targets one cost at a time, so by
+ * the time the cell is reached, every cell that costs less already has
+ * its final cost. directionToSmallest() only ever chooses a neighbour
+ * that costs less than the cell itself, so it gives the same result
+ * here as after a full flood. So does any cell downhill of this one.
+ * Cells further away than the given cell may be left at MAX_COST.
+ *
+ * If the cell cannot be reached, the flood runs to completion and the
+ * cell is left at MAX_COST as usual.
+ *
+ * The costs cannot be used by mazeFloodUpdate(), printed or used for a
+ * speed run. The next mazeFloodUpdate() will do a full flood.
+ *
+ * @param targets   - the cells from which all distances are calculated
+ * @param from      - the cell whose cost is needed
+ * @param knownOnly - use only the passages the mouse has seen
+ */
+void mazeFloodTo(const CellSet &targets, cell_t from, bool knownOnly) {
+  floodTargets = targets;
+  floodStale = true;
+  if (knownOnly) {
+    floodCells<true, false>(targets, from);
+  } else {
+    floodCells<false, false>(targets, from);
+  }
+}
+
+/***
+ * mazeFlood() into costKnown[] instead of cost[] so that the costs to
+ * two different sets of targets can be held at once. Anything left in
+ * costKnown[] by mazeFloodDual() is lost.
+ *
+ * cost[] is not changed and can still be used with mazeFloodUpdate().
+ *
+ * @param targets - the cells from which all distances are calculated
+ */
+void mazeFloodSecond(const CellSet &targets) {
+  floodCells<false, true>(targets);
+}
+
+// the two floods of mazeFloodDual() one after the other. Each queues a cell at most once
+static void floodDualSeparately(const CellSet &targets) {
+  mazeFlood(targets);
+  floodCells<true, true>(targets);
+}
+
+/***
+ * Flood both ways at once. On return, cost[] holds the same costs as
+ * mazeFlood() and costKnown[] holds the same costs as mazeFloodKnown().
+ *
+ * The two floods share the queue and the walls of each cell are only
+ * looked up once. Each cell goes into the queue when its optimistic
+ * cost is set, as in mazeFlood(). Since the queue holds the cells in
+ * order of their optimistic cost, a cell given a known cost equal to
+ * its optimistic cost has not been taken from the queue yet and will
+ * pass both costs on together. Only cells where the known route is
+ * longer go round again. Once the maze has been explored, that is very
+ * few of them and the pair takes little longer than a single flood.
+ *
+ * A cell can be in the queue twice so, in a maze that fills it, the two
+ * floods are done one after the other instead.
+ *
+ * cost[] is suitable for mazeFloodUpdate() afterwards.
+ *
+ * @param targets - the cells from which all distances are calculated
  */
-void mazeFlood(unsigned char target) {
-  for (int i = 0; i < 256; i++) {
+void mazeFloodDual(const CellSet &targets) {
+  floodTargets = targets;
+  floodStale = false;
+  for (int i = 0; i < MAZE_CELLS; i++) {
     cost[i] = MAX_COST;
+    costKnown[i] = MAX_COST;
+  }
+  Queue<cell_t, FLOOD_QUEUE_SIZE> queue;
+  for (unsigned char i = 0; i < targets.count; i++) {
+    cost[targets.cells[i]] = 0;
+    costKnown[targets.cells[i]] = 0;
+    queue.add(targets.cells[i]);
   }
-  Queue<unsigned char> queue;
-  cost[target] = 0;
-  queue.add(target);
   while (queue.size() > 0) {
-    unsigned char here = queue.head();
+    cell_t here = queue.head();
     unsigned int newCost = cost[here] + 1;
+    unsigned int newKnown = costKnown[here] + 1;
+    unsigned char exits = ~walls[here];
+    unsigned char knownExits = 0;
+    if (newKnown <= MAX_COST) {
+      // the walls of a visited cell are all known without looking them up
+      knownExits = exits & ((walls[here] & VISITED) ? 0x0f : knownWalls(here));
+    }
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (exits & (1 << direction)) {
+        cell_t nextCell = neighbour(here, direction);
+        if (cost[nextCell] > newCost) {
+          if (queue.full()) {
+            floodDualSeparately(targets);
+            return;
+          }
+          cost[nextCell] = newCost;
+          queue.add(nextCell);
+        }
+        if ((knownExits & (1 << direction)) && costKnown[nextCell] > newKnown) {
+          if (cost[nextCell] != newKnown && queue.full()) {
+            floodDualSeparately(targets);
+            return;
+          }
+          costKnown[nextCell] = newKnown;
+          if (cost[nextCell] != newKnown) {
+            queue.add(nextCell);
+          }
+        }
+      }
+    }
+  }
+}
+
+/***
+ * Decide whether the shortest route from a cell to the nearest of the
+ * targets is already known.
+ *
+ * The optimistic flood, with unknown walls open, gives a lower bound for
+ * the route length while the pessimistic flood, with unknown walls
+ * closed, gives the length of a route that certainly exists. When they
+ * agree, no unexplored wall can shorten the route and there is nothing
+ * more to learn by searching.
+ *
+ * On return, the cost array holds the optimistic flood to the targets
+ * so the search can carry on from it.
+ *
+ * @param from    - one end of the route
+ * @param targets - the other end, from which the costs are flooded
+ */
+bool mazeRouteProven(cell_t from, const CellSet &targets) {
+  mazeFloodDual(targets);
+  return costKnown[from] != MAX_COST && costKnown[from] == cost[from];
+}
 
+// during mazeRoute(), costKnown[] holds the state of each cell. The low
+// two bits are the direction back towards the end it was reached from
+#define ROUTE_FROM   0x04	// reached from the start cell
+#define ROUTE_TARGET 0x08	// reached from the targets
+#define ROUTE_ENDS   (ROUTE_FROM | ROUTE_TARGET)
+
+/***
+ * Take every cell at the current distance from one end of the route
+ * search off its queue and add their unseen neighbours. Returns true,
+ * with the passage where the two ends meet, as soon as a neighbour turns
+ * out to have been reached from the other end.
+ *
+ * Both ends grow a whole layer at a time. When they first meet, every
+ * cell already reached from the other end that is next to this layer
+ * is on its outermost layer so any meeting point found during the layer
+ * gives a route of the same, shortest, length.
+ */
+template <bool KNOWN_ONLY>
+static bool routeLayer(Queue<cell_t, FLOOD_QUEUE_SIZE> &queue, unsigned char side,
+                       cell_t &meet, unsigned char &meetDirection) {
+  int count = queue.size();
+  while (count-- > 0) {
+    cell_t here = queue.head();
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (KNOWN_ONLY ? hasKnownExit(here, direction) : hasExit(here,  direction)) {
+        cell_t next = neighbour(here, direction);
+        unsigned char state = costKnown[next] & ROUTE_ENDS;
+        if (state == 0) {
+          costKnown[next] = side | DtoB[direction];
+          queue.add(next);
+        } else if (state != side) {
+          meet = here;
+          meetDirection = direction;
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/***
+ * Grow the route search from both ends, a layer at a time from whichever
+ * end has fewer cells waiting, until they meet. Returns false if one end
+ * runs out of cells first. Otherwise, cell is on the side of the start
+ * and direction goes across the meeting passage towards the targets.
+ */
+template <bool KNOWN_ONLY>
+static bool routeMeet(cell_t from, const CellSet &targets, cell_t &cell, unsigned char &direction) {
+  Queue<cell_t, FLOOD_QUEUE_SIZE> fromQueue;
+  Queue<cell_t, FLOOD_QUEUE_SIZE> targetQueue;
+  for (unsigned char i = 0; i < targets.count; i++) {
+    costKnown[targets.cells[i]] = ROUTE_TARGET;
+    targetQueue.add(targets.cells[i]);
+  }
+  costKnown[from] = ROUTE_FROM;
+  fromQueue.add(from);
+  while (fromQueue.size() > 0 && targetQueue.size() > 0) {
+    cell_t meet;
+    unsigned char meetDirection;
+    if (fromQueue.size() <= targetQueue.size()) {
+      if (routeLayer<KNOWN_ONLY>(fromQueue, ROUTE_FROM, meet, meetDirection)) {
+        cell = meet;
+        direction = meetDirection;
+        return true;
+      }
+    } else if (routeLayer<KNOWN_ONLY>(targetQueue, ROUTE_TARGET, meet, meetDirection)) {
+      cell = neighbour(meet, meetDirection);
+      direction = DtoB[meetDirection];
+      return true;
+    }
+  }
+  return false;
+}
+
+/***
+ * Find a shortest route from one cell to the nearest of the targets
+ * without flooding the whole maze. The search grows outwards from both
+ * ends at once and stops where they meet. With knownOnly set, only the
+ * passages the mouse has seen are used, as in mazeFloodKnown().
+ *
+ * The route is as long as the cost a flood would give the cell but,
+ * where there are several, need not be the same one. It is written to
+ * directions[] as the direction of each move in turn. See pathRoute()
+ * for a route as a path string.
+ *
+ * Uses costKnown[] as working space. cost[] is not changed.
+ *
+ * Returns the number of moves, or -1 if there is no route.
+ *
+ * @param from       - the cell where the route starts
+ * @param targets    - the cells where it may end
+ * @param knownOnly  - use only the passages the mouse has seen
+ * @param directions - set to the moves. It needs room for as many as
+ *                     MAZE_CELLS - 1
+ */
+int mazeRoute(cell_t from, const CellSet &targets, bool knownOnly, unsigned char *directions) {
+  if (targets.contains(from)) {
+    return 0;
+  }
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    costKnown[i] = 0;
+  }
+  cell_t cell;
+  unsigned char direction;
+  bool met = knownOnly ? routeMeet<true>(from, targets, cell, direction)
+             : routeMeet<false>(from, targets, cell, direction);
+  if (!met) {
+    return -1;
+  }
+  // work back from the meeting point to the start
+  int length = 0;
+  for (cell_t here = cell; here != from; here = neighbour(here, costKnown[here] & 0x03)) {
+    directions[length++] = DtoB[costKnown[here] & 0x03];
+  }
+  for (int i = 0; i < length / 2; i++) {
+    unsigned char swap = directions[i];
+    directions[i] = directions[length - 1 - i];
+    directions[length - 1 - i] = swap;
+  }
+  // then on across the meeting passage to the target
+  directions[length++] = direction;
+  for (cell = neighbour(cell, direction); !targets.contains(cell); cell = neighbour(cell, costKnown[cell] & 0x03)) {
+    directions[length++] = costKnown[cell] & 0x03;
+  }
+  return length;
+}
+
+/***
+ * Incremental version of mazeFlood() for use while searching.
+ *
+ * During a search, walls are only ever added and they are only added
+ * around the cell the mouse has just entered. Costs can then only go up
+ * and the only cells affected are those whose route to the target went
+ * through one of the new walls. Rather than flood every cell again,
+ * the existing cost array is repaired in two passes:
+ *
+ * First, starting with the given cell and its neighbours, any cell that
+ * no longer has an open neighbour one step closer to the target has lost
+ * its route. It is marked with MAX_COST and the cells that were relying
+ * on it are examined in turn.
+ *
+ * Second, every cell that was marked is given a new cost from its cheapest
+ * neighbour and any improvements are passed on until nothing changes.
+ *
+ * The result is identical to a full flood to the same target. If the
+ * queue should ever fill up, the repair is abandoned and a full flood
+ * is done instead. So it is if mazeInferWalls() has added walls since
+ * the last full flood as they may be anywhere, or if the last flood was
+ * not a complete mazeFlood().
+ *
+ * When only a side wall is found, nothing needs to change and the
+ * update takes a few tens of microseconds.
+ *
+ * Assumes that cost[] holds a complete flood to the last target and that
+ * the only changes since then are walls added around the given cell.
+ *
+ * @param cell - the cell whose walls have just been updated
+ */
+void mazeFloodUpdate(cell_t cell) {
+  if (floodStale) {
+    mazeFlood(floodTargets);
+    return;
+  }
+  Queue<cell_t, FLOOD_QUEUE_SIZE> queue;
+  int orphans = 0;
+  queue.add(cell);
+  for (unsigned char direction = 0; direction < 4; direction++) {
+    queue.add(neighbour(cell, direction));
+  }
+  // pass 1: find the cells that no longer have a route
+  while (queue.size() > 0) {
+    cell_t here = queue.head();
+    cost_t hereCost = cost[here];
+    if (hereCost == 0 || hereCost == MAX_COST) {	// targets need no route
+      continue;
+    }
+    bool supported = false;
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (hasExit(here, direction) && cost[neighbour(here, direction)] == hereCost - 1) {
+        supported = true;
+        break;
+      }
+    }
+    if (supported) {
+      continue;
+    }
+    cost[here] = MAX_COST;
+    orphans++;
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (hasExit(here, direction)) {
+        cell_t nextCell = neighbour(here, direction);
+        if (cost[nextCell] == hereCost + 1) {
+          if (queue.full()) {
+            mazeFlood(floodTargets);
+            return;
+          }
+          queue.add(nextCell);
+        }
+      }
+    }
+  }
+  if (orphans == 0) {
+    return;
+  }
+  // pass 2: give them new costs from their neighbours
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    if (cost[i] != MAX_COST) {
+      continue;
+    }
+    unsigned int smallest = MAX_COST;
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if (hasExit(i, direction) && cost[neighbour(i, direction)] < smallest) {
+        smallest = cost[neighbour(i, direction)];
+      }
+    }
+    if (smallest + 1 < MAX_COST) {
+      if (queue.full()) {
+        mazeFlood(floodTargets);
+        return;
+      }
+      cost[i] = smallest + 1;
+      queue.add(i);
+    }
+  }
+  while (queue.size() > 0) {
+    cell_t here = queue.head();
+    unsigned int newCost = cost[here] + 1;
     for (unsigned char direction = 0; direction < 4; direction++) {
       if (hasExit(here,  direction)) {
-        unsigned int nextCell = neighbour(here, direction);
+        cell_t nextCell = neighbour(here, direction);
         if (cost[nextCell] > newCost) {
+          if (queue.full()) {
+            mazeFlood(floodTargets);
+            return;
+          }
           cost[nextCell] = newCost;
           queue.add(nextCell);
         }
@@ -237,6 +1083,185 @@ void mazeFlood(unsigned char target) {
 }
 
 
+#if defined(FLOOD_AVX2)
+/***
+ * Host builds only. With AVX2 the whole maze fits in a single register so
+ * every row of a layer is expanded at once. The rows are moved north or
+ * south by shifting the register by one 16 bit lane.
+ */
+static bool floodLayerAll(const uint16_t *layer, uint16_t *next, uint16_t *seen) {
+  __m256i here = _mm256_loadu_si256((const __m256i *)layer);
+  __m256i north = _mm256_loadu_si256((const __m256i *)rowNorthWalls);
+  __m256i east = _mm256_loadu_si256((const __m256i *)rowEastWalls);
+  __m256i old = _mm256_loadu_si256((const __m256i *)seen);
+  __m256i cells = _mm256_slli_epi16(_mm256_andnot_si256(east, here), 1);
+  cells = _mm256_or_si256(cells, _mm256_andnot_si256(east, _mm256_srli_epi16(here, 1)));
+  __m256i up = _mm256_andnot_si256(north, here);
+  up = _mm256_alignr_epi8(up, _mm256_permute2x128_si256(up, up, 0x08), 14);
+  __m256i down = _mm256_alignr_epi8(_mm256_permute2x128_si256(here, here, 0x81), here, 2);
+  cells = _mm256_or_si256(cells, _mm256_or_si256(up, _mm256_andnot_si256(north, down)));
+  cells = _mm256_andnot_si256(old, cells);
+  _mm256_storeu_si256((__m256i *)seen, _mm256_or_si256(old, cells));
+  _mm256_storeu_si256((__m256i *)next, cells);
+  return !_mm256_testz_si256(cells, cells);
+}
+#elif defined(FLOOD_SSE2)
+/***
+ * Host builds only. With SSE2 the maze is held in two registers of eight
+ * rows each and the rows are moved north or south by byte shifts with the
+ * carry passed between the two halves.
+ */
+static bool floodLayerAll(const uint16_t *layer, uint16_t *next, uint16_t *seen) {
+  __m128i here0 = _mm_loadu_si128((const __m128i *)layer);
+  __m128i here1 = _mm_loadu_si128((const __m128i *)(layer + 8));
+  __m128i north0 = _mm_loadu_si128((const __m128i *)rowNorthWalls);
+  __m128i north1 = _mm_loadu_si128((const __m128i *)(rowNorthWalls + 8));
+  __m128i east0 = _mm_loadu_si128((const __m128i *)rowEastWalls);
+  __m128i east1 = _mm_loadu_si128((const __m128i *)(rowEastWalls + 8));
+  __m128i old0 = _mm_loadu_si128((const __m128i *)seen);
+  __m128i old1 = _mm_loadu_si128((const __m128i *)(seen + 8));
+  __m128i cells0 = _mm_slli_epi16(_mm_andnot_si128(east0, here0), 1);
+  __m128i cells1 = _mm_slli_epi16(_mm_andnot_si128(east1, here1), 1);
+  cells0 = _mm_or_si128(cells0, _mm_andnot_si128(east0, _mm_srli_epi16(here0, 1)));
+  cells1 = _mm_or_si128(cells1, _mm_andnot_si128(east1, _mm_srli_epi16(here1, 1)));
+  __m128i up0 = _mm_andnot_si128(north0, here0);
+  __m128i up1 = _mm_andnot_si128(north1, here1);
+  cells1 = _mm_or_si128(cells1, _mm_or_si128(_mm_slli_si128(up1, 2), _mm_srli_si128(up0, 14)));
+  cells0 = _mm_or_si128(cells0, _mm_slli_si128(up0, 2));
+  __m128i down0 = _mm_or_si128(_mm_srli_si128(here0, 2), _mm_slli_si128(here1, 14));
+  __m128i down1 = _mm_srli_si128(here1, 2);
+  cells0 = _mm_andnot_si128(old0, _mm_or_si128(cells0, _mm_andnot_si128(north0, down0)));
+  cells1 = _mm_andnot_si128(old1, _mm_or_si128(cells1, _mm_andnot_si128(north1, down1)));
+  _mm_storeu_si128((__m128i *)seen, _mm_or_si128(old0, cells0));
+  _mm_storeu_si128((__m128i *)(seen + 8), _mm_or_si128(old1, cells1));
+  _mm_storeu_si128((__m128i *)next, cells0);
+  _mm_storeu_si128((__m128i *)(next + 8), cells1);
+  __m128i any = _mm_or_si128(cells0, cells1);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xffff;
+}
+#else
+/***
+ * Work out the next layer of a bitboard flood. Each entry is one row of
+ * the maze with one bit per column. A cell joins the next layer if it has
+ * not been seen before and can be reached from any cell in the current
+ * layer without passing through a wall.
+ *
+ * Only the rows from first to last can hold cells in the current layer so
+ * only they, and the rows either side, need to be examined. Rows of the
+ * layer outside that range may hold cells from an earlier layer but all
+ * their neighbours have already been seen so they add nothing.
+ *
+ * Returns true if the next layer has any cells in it.
+ */
+static bool floodLayer(const row_t *layer, row_t *next, row_t *seen, int first, int last) {
+  bool found = false;
+  int low = (first > 0) ? first - 1 : 0;
+  int high = (last < MAZE_HEIGHT - 1) ? last + 1 : MAZE_HEIGHT - 1;
+  for (int row = low; row <= high; row++) {
+    row_t here = layer[row];
+    row_t open = ~rowEastWalls[row];
+    row_t cells = ((here & open) << 1) | ((here >> 1) & open);
+    if (row > 0) {
+      cells |= layer[row - 1] & ~rowNorthWalls[row - 1];
+    }
+    if (row < MAZE_HEIGHT - 1) {
+      cells |= layer[row + 1] & ~rowNorthWalls[row];
+    }
+    cells &= ~seen[row];
+    seen[row] |= cells;
+    next[row] = cells;
+    if (cells) {
+      found = true;
+    }
+  }
+  return found;
+}
+#endif
+
+/***
+ * Bitboard version of mazeFlood(). The result in cost[] is identical.
+ *
+ * Instead of examining one cell and one wall at a time, a complete row
+ * of the flood front is moved in each direction at once using the
+ * bitboard copies of the walls. Every cell in a layer is the same
+ * distance from the target so cost[] is filled in one layer at a time.
+ *
+ * Unlike mazeFlood(), the bitboards do not wrap around the edges of the
+ * maze so the maze must have its border walls. A contest maze always will.
+ *
+ * @param targets - the cells from which all distances are calculated
+ */
+void mazeFloodBits(const CellSet &targets) {
+  row_t seen[MAZE_HEIGHT];
+  row_t layers[2][MAZE_HEIGHT];
+  floodTargets = targets;
+  floodStale = false;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    cost[i] = MAX_COST;
+  }
+  for (int row = 0; row < MAZE_HEIGHT; row++) {
+    seen[row] = 0;
+    layers[0][row] = 0;
+    layers[1][row] = 0;
+  }
+  int first = MAZE_HEIGHT - 1;
+  int last = 0;
+  for (unsigned char i = 0; i < targets.count; i++) {
+    int row = targets.cells[i] % MAZE_HEIGHT;
+    layers[0][row] |= (row_t)1 << (targets.cells[i] / MAZE_HEIGHT);
+    seen[row] = layers[0][row];
+    if (row < first) {
+      first = row;
+    }
+    if (row > last) {
+      last = row;
+    }
+  }
+  cost_t distance = 0;
+  bool more = true;
+  while (more) {
+    row_t *layer = layers[distance & 1];
+    row_t *next = layers[(distance + 1) & 1];
+    int newFirst = MAZE_HEIGHT - 1;
+    int newLast = 0;
+    for (int row = first; row <= last; row++) {
+      row_t bits = layer[row];
+      if (bits) {
+        if (row < newFirst) {
+          newFirst = row;
+        }
+        newLast = row;
+      }
+      cell_t cell = row;
+      while (bits) {
+        if ((bits & 0x0f) == 0) {	// skip empty columns four at a time
+          bits >>= 4;
+          cell += 4 * MAZE_HEIGHT;
+          continue;
+        }
+        if (bits & 1) {
+          cost[cell] = distance;
+        }
+        bits >>= 1;
+        cell += MAZE_HEIGHT;
+      }
+    }
+    first = newFirst;
+    last = newLast;
+#if defined(FLOOD_AVX2) || defined(FLOOD_SSE2)
+    more = floodLayerAll(layer, next, seen);
+    first = 0;
+    last = MAZE_HEIGHT - 1;
+#else
+    more = floodLayer(layer, next, seen, first, last);
+    first = (first > 0) ? first - 1 : 0;
+    last = (last < MAZE_HEIGHT - 1) ? last + 1 : MAZE_HEIGHT - 1;
+#endif
+    distance++;
+  }
+}
+
+
 /***
  * Algorithm looks around the current cell and records the smallest
  * neighbour and its direction. By starting with the supplied direction,
@@ -247,7 +1272,7 @@ void mazeFlood(unsigned char target) {
  * @param startDirection
  * @return
  */
-unsigned char directionToSmallest(unsigned char cell, unsigned char startDirection) {
+unsigned char directionToSmallest(cell_t cell, unsigned char startDirection) {
   unsigned char nextDirection = startDirection;
   unsigned char smallestDirection = INVALID_DIRECTION;
   unsigned int nextCost;
@@ -288,10 +1313,12 @@ unsigned char directionToSmallest(unsigned char cell, unsigned char startDirecti
  * them without using the PROGMEM stuff
  */
 void mazeCopyWallsFromFlash(const unsigned char *src) {
-  memcpy_P(walls, src, 256);
+  memcpy_P(walls, src, MAZE_CELLS);
+  mazeSyncBitboards();
 }
 
 // some sample maze data
+#if MAZE_WIDTH == 16 && MAZE_HEIGHT == 16
 const PROGMEM unsigned char emptyMaze[] = {
   0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x09,
   0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
@@ -333,5 +1360,6 @@ const PROGMEM unsigned char japan2007[] = {
   0x05, 0x06, 0x03, 0x06, 0x03, 0x06, 0x03, 0x06, 0x09, 0x06, 0x0A, 0x02, 0x0B, 0x06, 0x01, 0x05,
   0x06, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x02, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x02, 0x03
 };
+#endif
 
 //--------------------------------------------------------------------------
@@ -28,7 +28,52 @@
 #ifndef MAZE_H
 #define MAZE_H
 
-#define GOAL 0x77
+#include <stdint.h>
+
+/***
+ * The maze geometry is fixed at compile time. The classic contest maze
+ * is 16 x 16. Half-size contests use a 32 x 32 maze but that needs more
+ * RAM than the ATmega32U4 has so it is only useful on larger processors
+ * or when running the maze code on a host.
+ *
+ * Cells are numbered in columns from the south west corner so that
+ * cell = row + MAZE_HEIGHT * column.
+ *
+ * Cell indices and costs only widen to 16 bits when there are more than
+ * 256 cells. For the classic maze all the arithmetic below reduces to the
+ * same byte operations as the original hard coded values.
+ */
+#ifndef MAZE_WIDTH
+#define MAZE_WIDTH 16
+#endif
+#ifndef MAZE_HEIGHT
+#define MAZE_HEIGHT 16
+#endif
+#define MAZE_CELLS (MAZE_WIDTH * MAZE_HEIGHT)
+#define MAX_SIDE ((MAZE_WIDTH > MAZE_HEIGHT) ? MAZE_WIDTH : MAZE_HEIGHT)
+
+#if MAZE_CELLS > 256
+typedef uint16_t cell_t;
+typedef uint16_t cost_t;
+#define MAX_COST 0xFFFF
+#else
+typedef unsigned char cell_t;
+typedef unsigned char cost_t;
+#define MAX_COST 255
+#endif
+
+// one bit per column in each row of the wall bitboards
+#if MAZE_WIDTH > 16
+typedef uint32_t row_t;
+#else
+typedef uint16_t row_t;
+#endif
+
+// the goal is the south west cell of the central four
+#define GOAL ((MAZE_HEIGHT / 2 - 1) + MAZE_HEIGHT * (MAZE_WIDTH / 2 - 1))
+
+// the whole of the central goal area
+#define GOAL_REGION CellSet(GOAL, GOAL + 1, GOAL + MAZE_HEIGHT, GOAL + MAZE_HEIGHT + 1)
 
 // directions for mapping
 #define NORTH 0
@@ -39,43 +84,142 @@
 #define VISITED 0xf0
 
 #define INVALID_DIRECTION (0)
-#define MAX_COST 255
 
+// the size of the work queue used when flooding the maze. The flood front
+// grows with the size of the maze. This must be a power of two.
+#if MAZE_CELLS > 256
+#define FLOOD_QUEUE_SIZE 256
+#else
+#define FLOOD_QUEUE_SIZE 64
+#endif
+
+// the sample mazes are only stored for the classic maze size
+#if MAZE_WIDTH == 16 && MAZE_HEIGHT == 16
 extern const  unsigned char emptyMaze[];
 extern const  unsigned char japan2007[];
-
+#endif
+
+
+// the most cells a flood can start from
+#define CELL_SET_MAX 4
+
+/***
+ * A small set of cells that are flooded from, or searched to, together.
+ * Every cell in the set has a cost of zero after the flood so a search
+ * can stop in whichever one it reaches first. A single cell converts to
+ * a set of its own so either can be given as a target.
+ */
+class CellSet {
+public:
+  CellSet(cell_t cell) : count(1) {
+    cells[0] = cell;
+  }
+  CellSet(cell_t a, cell_t b, cell_t c, cell_t d) : count(4) {
+    cells[0] = a;
+    cells[1] = b;
+    cells[2] = c;
+    cells[3] = d;
+  }
+  bool contains(cell_t cell) const {
+    for (unsigned char i = 0; i < count; i++) {
+      if (cells[i] == cell) {
+        return true;
+      }
+    }
+    return false;
+  }
+  unsigned char count;
+  cell_t cells[CELL_SET_MAX];
+};
 
 // tables give new direction from current heading and next turn
 const unsigned char DtoR[] = { 1, 2, 3, 0};
 const unsigned char DtoB[] = { 2, 3, 0, 1};
 const unsigned char DtoL[] = { 3, 0, 1, 2};
 
-extern unsigned char cost[256];
-extern unsigned char walls[256];
-
-
-
-inline bool hasExit(unsigned char cell, unsigned char direction) {
+/***
+ * The cell counting floods and the speed run planner never need their
+ * working arrays at the same time so they share one block of memory.
+ * plannerFlood() loses cost[] and costKnown[] and calls mazeCostsLost()
+ * so that the next mazeFloodUpdate() floods afresh. See planner.cpp for
+ * the planner's part.
+ */
+struct FloodScratch {
+  cost_t cost[MAZE_CELLS];
+  cost_t known[MAZE_CELLS];	// the pessimistic costs from mazeFloodDual()
+};
+
+struct PlannerScratch {
+  unsigned int time[MAZE_CELLS];
+  unsigned char link[MAZE_CELLS];
+  cell_t queue[MAZE_CELLS];
+  unsigned char waiting[(MAZE_CELLS + 7) / 8];
+};
+
+union MazeScratch {
+  FloodScratch flood;
+  PlannerScratch planner;
+};
+
+extern MazeScratch mazeScratch;
+static constexpr cost_t (&cost)[MAZE_CELLS] = mazeScratch.flood.cost;
+static constexpr cost_t (&costKnown)[MAZE_CELLS] = mazeScratch.flood.known;
+
+extern unsigned char walls[MAZE_CELLS];
+extern row_t rowNorthWalls[MAZE_HEIGHT];
+extern row_t rowEastWalls[MAZE_HEIGHT];
+extern row_t rowNorthKnown[MAZE_HEIGHT];
+extern row_t rowEastKnown[MAZE_HEIGHT];
+extern row_t rowNorthInferred[MAZE_HEIGHT];
+extern row_t rowEastInferred[MAZE_HEIGHT];
+extern row_t rowPruned[MAZE_HEIGHT];
+extern int mazePrunedCount;
+extern unsigned int mazeGeneration;
+extern unsigned int mazeOpened;
+extern unsigned int mazeLearned;
+
+
+
+inline bool hasExit(cell_t cell, unsigned char direction) {
   return ((walls[cell] & (1 << direction)) == 0);
 }
 
-inline bool hasWall(unsigned char cell, unsigned char direction) {
+inline bool hasWall(cell_t cell, unsigned char direction) {
   return ((walls[cell] & (1 << direction)) != 0);
 }
 
-unsigned char cellNorth(unsigned char cell);
-unsigned char cellEast(unsigned char cell);
-unsigned char cellSouth(unsigned char cell);
-unsigned char cellWest(unsigned char cell);
-unsigned char neighbour(unsigned char cell, unsigned char direction);
-unsigned char neighbourCost(unsigned char cell, unsigned char direction);
-unsigned char directionToSmallest(unsigned char cell, unsigned char startDirection);
+bool hasKnownExit(cell_t cell, unsigned char direction);
+
+cell_t cellNorth(cell_t cell);
+cell_t cellEast(cell_t cell);
+cell_t cellSouth(cell_t cell);
+cell_t cellWest(cell_t cell);
+cell_t neighbour(cell_t cell, unsigned char direction);
+cost_t neighbourCost(cell_t cell, unsigned char direction);
+unsigned char directionToSmallest(cell_t cell, unsigned char startDirection);
 
 void mazeCopyWallsFromFlash(const unsigned char *src);
-void mazeSetWall(unsigned char cell, unsigned char direction);
+void mazeSetWall(cell_t cell, unsigned char direction);
+void mazeClearWall(cell_t cell, unsigned char direction);
+void mazeSyncBitboards();
+void mazeCostsLost();
+void mazeSetKnown(cell_t cell, unsigned char direction);
+bool mazeWallKnown(cell_t cell, unsigned char direction);
+void mazeMarkVisited(cell_t cell);
+bool mazeWallInferred(cell_t cell, unsigned char direction);
+void mazeInferWalls(cell_t cell);
+bool mazeCellPruned(cell_t cell);
 
 void mazeInit(const unsigned char *testMaze);
-void mazeFlood(unsigned char target);
+void mazeFlood(const CellSet &targets);
+void mazeFloodKnown(const CellSet &targets);
+void mazeFloodTo(const CellSet &targets, cell_t from, bool knownOnly = false);
+void mazeFloodDual(const CellSet &targets);
+void mazeFloodSecond(const CellSet &targets);
+bool mazeRouteProven(cell_t from, const CellSet &targets);
+int mazeRoute(cell_t from, const CellSet &targets, bool knownOnly, unsigned char *directions);
+void mazeFloodUpdate(cell_t cell);
+void mazeFloodBits(const CellSet &targets);
 
 
 
@@ -0,0 +1,156 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#include "mazefile.h"
+#include "maze.h"
+
+static unsigned char fileFormat;
+static int fileLine;		// text: rows of posts and cells so far. binary: cells so far
+static int fileColumn;		// text: characters so far in this line
+static bool fileStarted;	// text: the first row of posts has been seen
+
+/***
+ * Prepare to load a maze in the given format. All the walls are removed
+ * so that only those in the file will be set.
+ */
+void mazeFileBegin(unsigned char format) {
+  fileFormat = format;
+  fileLine = 0;
+  fileColumn = 0;
+  fileStarted = false;
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    walls[i] = 0;
+  }
+  mazeSyncBitboards();
+}
+
+/***
+ * Returns true once a whole maze has been read.
+ */
+bool mazeFileComplete() {
+  if (fileFormat == MAZE_FILE_BINARY) {
+    return fileLine >= MAZE_CELLS;
+  }
+  return fileLine >= 2 * MAZE_HEIGHT + 1;
+}
+
+/***
+ * Lines of the text format alternate between posts and cells, starting
+ * and ending with posts. Only the middle character of each "---" and
+ * the character before each cell need to be looked at.
+ */
+static void mazeFileTextChar(char c) {
+  if (c == '\r') {
+    return;
+  }
+  if (c == '\n') {
+    if (fileStarted) {
+      fileLine++;
+    }
+    fileColumn = 0;
+    return;
+  }
+  if (!fileStarted) {
+    if (fileColumn == 0 && c == 'o') {
+      fileStarted = true;
+    } else {
+      fileColumn++;
+      return;
+    }
+  }
+  int col = fileColumn / 4;
+  int offset = fileColumn % 4;
+  fileColumn++;
+  int row = MAZE_HEIGHT - 1 - fileLine / 2;
+  if ((fileLine & 1) == 0) {
+    if (offset == 2 && col < MAZE_WIDTH && c == '-') {
+      if (row >= 0) {
+        mazeSetWall(row + MAZE_HEIGHT * col, NORTH);
+      } else {
+        mazeSetWall(MAZE_HEIGHT * col, SOUTH);
+      }
+    }
+    // the last row of posts is complete without waiting for a newline
+    if (row < 0 && fileColumn > 4 * MAZE_WIDTH) {
+      fileLine++;
+    }
+  } else if (offset == 0 && c == '|') {
+    if (col < MAZE_WIDTH) {
+      mazeSetWall(row + MAZE_HEIGHT * col, WEST);
+    } else if (col == MAZE_WIDTH) {
+      mazeSetWall(row + MAZE_HEIGHT * (MAZE_WIDTH - 1), EAST);
+    }
+  }
+}
+
+/***
+ * Read the next chunk of a maze file. Anything after the end of the maze
+ * is ignored.
+ *
+ * Returns true once a whole maze has been read.
+ */
+bool mazeFileRead(const char *chunk, int length) {
+  for (int i = 0; i < length && !mazeFileComplete(); i++) {
+    if (fileFormat == MAZE_FILE_BINARY) {
+      walls[fileLine++] = chunk[i] & 0x0f;
+      if (mazeFileComplete()) {
+        mazeSyncBitboards();
+      }
+    } else {
+      mazeFileTextChar(chunk[i]);
+    }
+  }
+  return mazeFileComplete();
+}
+
+/***
+ * Write the current walls in either format. The text is the same as that
+ * shown by printMazePlain().
+ */
+void mazeFileWrite(Print &out, unsigned char format) {
+  if (format == MAZE_FILE_BINARY) {
+    for (int i = 0; i < MAZE_CELLS; i++) {
+      out.write(walls[i] & 0x0f);
+    }
+    return;
+  }
+  for (int row = MAZE_HEIGHT - 1; row >= -1; row--) {
+    for (int col = 0; col < MAZE_WIDTH; col++) {
+      bool wall = (row >= 0) ? hasWall(row + MAZE_HEIGHT * col, NORTH) : hasWall(MAZE_HEIGHT * col, SOUTH);
+      out.print('o');
+      out.print(wall ? F("---") : F("   "));
+    }
+    out.print('o');
+    out.println();
+    if (row < 0) {
+      break;
+    }
+    for (int col = 0; col < MAZE_WIDTH; col++) {
+      out.print(hasExit(row + MAZE_HEIGHT * col, WEST) ? F("    ") : F("|   "));
+    }
+    out.print('|');
+    out.println();
+  }
+}
@@ -0,0 +1,57 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+#ifndef MAZEFILE_H
+#define MAZEFILE_H
+
+#include "Arduino.h"
+
+/***
+ * Maze files can be loaded and saved in two formats:
+ *
+ * Binary - the usual .maz format. One byte per cell in the same order as
+ * walls[] with the same wall bits: North = 1, East = 2, South = 4, West = 8
+ *
+ * Text - the ASCII art drawn by printMazePlain(). Posts are 'o', walls are
+ * "---" or '|'. Anything else inside a cell, such as a goal marker, is
+ * ignored, as are any blank lines before the first row of posts.
+ *
+ * Loading is streamed. Call mazeFileBegin() then pass the file to
+ * mazeFileRead() in chunks of any size, as they arrive. The walls are set
+ * as each chunk is read so there is no need to hold the whole file.
+ */
+
+enum {
+  MAZE_FILE_BINARY,
+  MAZE_FILE_TEXT
+};
+
+void mazeFileBegin(unsigned char format);
+bool mazeFileRead(const char *chunk, int length);
+bool mazeFileComplete();
+void mazeFileWrite(Print &out, unsigned char format);
+
+#endif //MAZEFILE_H
@@ -53,11 +53,12 @@ void setup() {
     // NOTE: the hardware serial port connection can provide enough power to
     // the processor to prevent it seeing a power down.
     console.println(F("\nPower Up - clearing maze.\n"));
-    mazeInit(emptyMaze);
+    mazeInit(NULL);
     mouseState = FRESH_START;
     boot_magic = 0xFEEDBEEF;
   }
-  mazeFlood(GOAL);
+  mazeSyncBitboards();  // the walls survive a reset but the bitboards do not
+  mazeFlood(GOAL_REGION);
   mouseInit();
   sensorsEnable();
   console << F("Free RAM: ") << getFreeRam() << F(" bytes") << endl;
@@ -28,12 +28,24 @@
 #include "motion.h"
 #include "parameters.h"
 #include "motors.h"
-#include "navigator.h"
 #include "src/hardware/volatiles.h"
 #include "src/hardware/hardware.h"
 #include "src/hardware/mouse.h"
 
+bool motionQueued;
 
+/***
+ * Put a segment on the motion queue, waiting for room if it is full, then
+ * wait for the motors to finish unless motionQueued is set.
+ */
+static void motionRun(const MotionSegment &segment) {
+  while (!motorsQueueSegment(segment)) {
+    ; // do nothing
+  }
+  if (!motionQueued) {
+    motorsWaitForMove();
+  }
+}
 
 /***
  * The integrated smooth turn simply speeds up the outer wheel and
@@ -59,14 +71,9 @@
  * ensure that the mouse can comfortably get down to the speed used when
  * setting up the phase1 and phase2 distances.
  *
- * The turning parameters - speeds, angles and distances - should really
- * be held in a table so that it is easy to look up the values
- * needed for different turn types. For example, rather than do two
- * successive right angle turns, it is better to do one smooth 180
- * degree turn.
- *
- * For this, the path processing will need more work and turnSmooth will
- * probably need to be given a turn type and direction.
+ * Turns of other angles use the same phase 1 distance with a phase 2
+ * distance to suit. The 45 and 135 degree turns of the diagonal runs
+ * are made this way.
  *
  * In a DC mouse, a very similar process is used. There are still the three
  * phases but the desired angular velocity is easily calculated in advance
@@ -74,49 +81,14 @@
  * the relation ship V = w x R always holds. R is the radius, V is the
  * tangential speed and w is the angular velocity. Thus, to run a turn
  * faster but with the same radius, w must be increased in proportion.
+ *
+ * The motor interrupts count off the phases so the turn can be queued
+ * behind the straight that leads into it. See motorsQueueSegment().
  */
-void turnSmooth(int direction) {
-  steeringMode = SM_NONE;
-  motorsSetDirection(FORWARD);
-  int phase1 = 220;	// adjust for radius
-  int phase2 = 500;	// adjust for angle
-  noInterrupts();
-  if (direction == RIGHT) {
-    speedTargetLeft = 800;
-    speedTargetRight = 1;
-  } else {
-    speedTargetLeft = 1;
-    speedTargetRight = 800;
-  }
-  positionCount = 0;
-  long targetSteps = phase1;
-  interrupts();
-  // phase 1 - accelerating phase
-  while (getStepCount() < targetSteps) {
-    ; // do nothing
-  }
-  // phase 2 - constant radius
-  noInterrupts();
-  speedTargetLeft = speedLeft;
-  speedTargetRight = speedRight;
-  targetSteps += phase2;
-  interrupts();
-  while (getStepCount() < targetSteps) {
-    ; // do nothing
-  }
-  // phase 3 - decelerating phase
-  noInterrupts();
-  speedTargetLeft = SPEEDMAX_SMOOTH_TURN;
-  speedTargetRight = SPEEDMAX_SMOOTH_TURN;
-  targetSteps += phase1;
-  interrupts();
-  while (getStepCount() < targetSteps) {
-    ; // do nothing
-  }
-  noInterrupts();
-  speedLeft = SPEEDMAX_SMOOTH_TURN;
-  speedRight = SPEEDMAX_SMOOTH_TURN;
-  interrupts();
+void turnSmooth(int direction, int phase2) {
+  // the phase lengths assume the speed changes by one index per step
+  MotionSegment arc = {SEGMENT_ARC, (unsigned char)direction, phase2, 0, SPEEDMAX_SMOOTH_TURN, PROFILE_TRAPEZOID};
+  motionRun(arc);
 }
 
 
@@ -130,43 +102,18 @@ void turnSmooth(int direction) {
  *
  * For a stepper mouse, this is easy because the number of steps needed
  * to bring a motor to a given speed index is just the difference in index
- * values for the two speeds.
+ * values for the two speeds. Other profiles take longer or shorter and
+ * profileSteps() works it out. See profile.h.
+ *
+ * The motor interrupts decide when to brake and when the move is over so
+ * that happens on exactly the right step. See motorsMove().
  *
- * Private to this module. Only call from other code that sets up the motor
- * directions correctly
+ * Private to this module. Only call with a direction that suits the type
  */
-void move(long steps, int maxSpeed, int exitSpeed) {
-  noInterrupts();
-  speedTargetLeft = maxSpeed;
-  speedTargetRight = maxSpeed;
-  positionCount = 0;
-  interrupts();
-  long brakingSteps;
-  long remainingSteps;
-  // accelerating phase
-  do {
-    remainingSteps = steps - getVolatile(positionCount);
-    brakingSteps = getVolatile(speedRight) + getVolatile(speedLeft);
-    // NOTE: do not divide speed by 2 as we want the total number of
-    // braking steps here
-    brakingSteps -= exitSpeed * 2;
-  } while (remainingSteps >= brakingSteps);
-  // decelerating phase
-  if (exitSpeed > 0) {
-    setVolatile(speedTargetRight, exitSpeed);
-    setVolatile(speedTargetLeft, exitSpeed);
-  } else { // ensure we get to that last step;
-    setVolatile(speedTargetRight, 1);
-    setVolatile(speedTargetLeft, 1);
-  }
-  while (getVolatile(positionCount) < steps) {
-    ; // do nothing
-  }
-  // force the current speed to match the set speed
-  setVolatile(speedTargetRight, exitSpeed);
-  setVolatile(speedTargetLeft, exitSpeed);
-  setVolatile(speedRight, exitSpeed);
-  setVolatile(speedLeft, exitSpeed);
+static void move(unsigned char type, int direction, long steps, int maxSpeed, int exitSpeed,
+                 const MotionProfile &profile) {
+  MotionSegment segment = {type, (unsigned char)direction, steps, maxSpeed, exitSpeed, profile};
+  motionRun(segment);
 }
 
 /***
@@ -177,14 +124,12 @@ void move(long steps, int maxSpeed, int exitSpeed) {
  * Normally, the exit speed would be zero but it need not be.
  */
 void spin(long steps, int maxSpeed, int exitSpeed) {
-  steeringMode = SM_NONE;
-  if (steps >= 0) {
-    motorsSetDirection(LEFT);
-  } else {
-    motorsSetDirection(RIGHT);
+  int direction = LEFT;
+  if (steps < 0) {
+    direction = RIGHT;
     steps = -steps;
   }
-  move(steps, maxSpeed, exitSpeed);
+  move(SEGMENT_SPIN, direction, steps, maxSpeed, exitSpeed, PROFILE_TRAPEZOID);
 }
 
 
@@ -198,6 +143,7 @@ void startForward(int maxSpeed) {
   motorsSetDirection(FORWARD);
   motorsResetCounters();
   noInterrupts();
+  motorsProfile = PROFILE_TRAPEZOID;
   speedTargetLeft = maxSpeed;
   speedTargetRight = maxSpeed;
   interrupts();
@@ -207,6 +153,7 @@ void startReverse(int maxSpeed) {
   motorsSetDirection(REVERSE);
   motorsResetCounters();
   noInterrupts();
+  motorsProfile = PROFILE_TRAPEZOID;
   speedTargetLeft = maxSpeed;
   speedTargetRight = maxSpeed;
   interrupts();
@@ -217,16 +164,16 @@ void startReverse(int maxSpeed) {
  * Move forward or backwards by the given number of steps.
  * Steps is the sum of the left and right motor steps
  * maxSpeed and exitSpeed are indexes into the acceleration table.
+ * The speed changes follow the profile. See profile.h
  *
  */
-void forward(long steps, int maxSpeed, int exitSpeed) {
-  if (steps >= 0) {
-    motorsSetDirection(FORWARD);
-  } else {
-    motorsSetDirection(REVERSE);
+void forward(long steps, int maxSpeed, int exitSpeed, const MotionProfile &profile) {
+  int direction = FORWARD;
+  if (steps < 0) {
+    direction = REVERSE;
     steps = -steps;
   }
-  move(steps, maxSpeed, exitSpeed);
+  move(SEGMENT_STRAIGHT, direction, steps, maxSpeed, exitSpeed, profile);
 }
 
 void turnIP180() {
@@ -247,13 +194,45 @@ void turnIP90L() {
 }
 
 void turnSS90L() {
-  turnSmooth(LEFT);
+  turnSmooth(LEFT, SMOOTH_TURN_PHASE2);
   mouse.heading = (mouse.heading + 3) & 0x03;
 }
 
 
 void turnSS90R() {
-  turnSmooth(RIGHT);
+  turnSmooth(RIGHT, SMOOTH_TURN_PHASE2);
   mouse.heading = (mouse.heading + 1) & 0x03;
 }
 
+/***
+ * Turns that leave or join a diagonal change the heading by an odd
+ * number of eighths of a turn. While the mouse is on a diagonal, the
+ * heading is the compass direction 45 degrees anticlockwise of the way
+ * it is actually going and mouse.diagonal is set.
+ */
+static void turnEighths(int eighths) {
+  int direction = (mouse.heading * 2 + (mouse.diagonal ? 1 : 0) + eighths) & 0x07;
+  mouse.heading = direction >> 1;
+  mouse.diagonal = (direction & 1) != 0;
+}
+
+void turnSS45L() {
+  turnSmooth(LEFT, SMOOTH_TURN_45_PHASE2);
+  turnEighths(-1);
+}
+
+void turnSS45R() {
+  turnSmooth(RIGHT, SMOOTH_TURN_45_PHASE2);
+  turnEighths(1);
+}
+
+void turnSS135L() {
+  turnSmooth(LEFT, SMOOTH_TURN_135_PHASE2);
+  turnEighths(-3);
+}
+
+void turnSS135R() {
+  turnSmooth(RIGHT, SMOOTH_TURN_135_PHASE2);
+  turnEighths(3);
+}
+
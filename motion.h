@@ -28,10 +28,20 @@
 #ifndef MOTION_H
 #define MOTION_H
 
+#include "profile.h"
+
+/***
+ * Set this to have forward(), spin() and the turns put their segment on
+ * the motion queue and return without waiting for it to be made. They
+ * only wait while the queue is full. The mouse heading is changed as a
+ * turn is queued. Clear it and call motorsWaitForMove() to catch up.
+ */
+extern bool motionQueued;
+
 void startForward(int maxSpeed);
 void startReverse(int maxSpeed);
 
-void forward(long steps, int maxSpeed, int exitSspeed);
+void forward(long steps, int maxSpeed, int exitSspeed, const MotionProfile &profile = PROFILE_TRAPEZOID);
 void spin(long steps, int maxSpeed, int exitSpeed);
 
 
@@ -41,6 +51,10 @@ void turnIP90R();
 void turnIP90L();
 void turnSS90L();
 void turnSS90R();
+void turnSS45L();
+void turnSS45R();
+void turnSS135L();
+void turnSS135R();
 
 
 
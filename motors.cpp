@@ -27,6 +27,9 @@
 #include "motors.h"
 #include "parameters.h"
 #include "acctable.h"
+#include "profile.h"
+#include "navigator.h"
+#include "src/hardware/queue.h"
 #include "src/hardware/volatiles.h"
 #include "src/hardware/hardware.h"
 
@@ -41,6 +44,26 @@ volatile int speedRight;
 bool slowLeftMotor;
 bool slowRightMotor;
 
+// the profile both motors follow to reach their target speeds. See profile.h
+MotionProfile motorsProfile = PROFILE_TRAPEZOID;
+static ProfileRamp rampLeft;
+static ProfileRamp rampRight;
+
+// the move the interrupts are making. See motorsMove()
+volatile bool motorsMoveDone = true;
+static bool moveActive;
+static bool moveBraking;
+static long moveSteps;	// the end of the move or, for an arc, of the current phase
+static int moveExitSpeed;
+static ProfileBraking moveBrakingLeft;	// the braking steps for the current speeds
+static ProfileBraking moveBrakingRight;
+
+// the motion queue. See motorsQueueSegment()
+static Queue<MotionSegment, MOTION_QUEUE_SIZE> moveQueue;
+static MotionSegment moveSegment;	// the segment being made
+static unsigned char moveArcPhase;
+static unsigned int moveSegmentCount;	// segments started since the last halt
+
 void motorsInit() {
   motorsSetDirection(FORWARD);
   setMicrostepMode(MICROSTEP_2);
@@ -66,16 +89,215 @@ void motorsSetDirection(int direction) {
   }
 }
 
-void motorRightUpdate() {
+static void moveStep();
 
-  unsigned int timerInterval;
+// the braking steps from the speeds at the start of a move. See profileBraking()
+static void moveBrakingStart() {
+  profileBrakingStart(moveBrakingLeft, speedLeft - moveExitSpeed, motorsProfile);
+  profileBrakingStart(moveBrakingRight, speedRight - moveExitSpeed, motorsProfile);
+}
+
+/***
+ * Start a segment from the motion queue, at whatever speed the motors
+ * are going. Only called with the interrupts off.
+ *
+ * An arc is the integrated smooth turn. See turnSmooth(). Its three
+ * phases are counted off here in place of the braking for a straight.
+ */
+static void moveStart(const MotionSegment &segment) {
+  moveSegment = segment;
+  moveSegmentCount++;
+  motorsProfile = segment.profile;
+  positionCount = 0;
+  moveExitSpeed = segment.exitSpeed;
+  moveBrakingStart();
+  moveBraking = false;
+  moveActive = true;
+  motorsMoveDone = false;
+  if (segment.type == SEGMENT_ARC) {
+    steeringMode = SM_NONE;
+    motorsSetDirection(FORWARD);
+    if (segment.direction == RIGHT) {
+      speedTargetLeft = 800;
+      speedTargetRight = 1;
+    } else {
+      speedTargetLeft = 1;
+      speedTargetRight = 800;
+    }
+    moveArcPhase = 1;
+    moveSteps = SMOOTH_TURN_PHASE1;
+  } else {
+    if (segment.type == SEGMENT_SPIN) {
+      steeringMode = SM_NONE;
+    }
+    motorsSetDirection(segment.direction);
+    speedTargetLeft = segment.maxSpeed;
+    speedTargetRight = segment.maxSpeed;
+    moveSteps = segment.steps;
+  }
+}
+
+// the move is over. Go straight on to the next segment if there is one
+static void moveFinish() {
+  // force the current speed to match the set speed
+  speedTargetLeft = moveExitSpeed;
+  speedTargetRight = moveExitSpeed;
+  speedLeft = moveExitSpeed;
+  speedRight = moveExitSpeed;
+  if (moveQueue.size() > 0) {
+    moveStart(moveQueue.head());
+    moveStep();
+  } else {
+    moveActive = false;
+    moveSegment.type = SEGMENT_NONE;
+    motorsMoveDone = true;
+  }
+}
 
-  if (speedRight < speedTargetRight) {
-    speedRight++;
+// an arc only changes the speed targets as each phase ends
+static void moveArcStep() {
+  if (positionCount < moveSteps) {
+    return;
+  }
+  if (moveArcPhase == 1) {
+    // phase 2 - hold the speeds reached for a constant radius
+    speedTargetLeft = speedLeft;
+    speedTargetRight = speedRight;
+    moveSteps += moveSegment.steps;
+  } else if (moveArcPhase == 2) {
+    // phase 3 - back to the entry speed
+    speedTargetLeft = moveExitSpeed;
+    speedTargetRight = moveExitSpeed;
+    moveSteps += SMOOTH_TURN_PHASE1;
+  } else {
+    moveFinish();
+    return;
+  }
+  moveArcPhase++;
+}
+
+/***
+ * Called by the motor interrupts after every step, and once as a move
+ * starts, to brake and finish at exactly the right step.
+ *
+ * Braking starts at the first step where the steps left are fewer than
+ * the braking steps for both motors, as move() has always done. Those are
+ * worked out in full as the move starts and then only counted on or off
+ * as the speeds change so there is no division here. See profileBraking().
+ */
+static void moveStep() {
+  if (!moveActive) {
+    return;
   }
-  if (speedRight > speedTargetRight) {
-    speedRight--;
+  if (moveSegment.type == SEGMENT_ARC) {
+    moveArcStep();
+    return;
   }
+  if (!moveBraking) {
+    long braking = profileBraking(moveBrakingLeft, speedLeft - moveExitSpeed, motorsProfile) +
+                   profileBraking(moveBrakingRight, speedRight - moveExitSpeed, motorsProfile);
+    if (moveSteps - positionCount < braking) {
+      moveBraking = true;
+      // with no exit speed, keep moving to get to that last step
+      int brakeSpeed = moveExitSpeed > 0 ? moveExitSpeed : 1;
+      speedTargetLeft = brakeSpeed;
+      speedTargetRight = brakeSpeed;
+    }
+  }
+  if (positionCount >= moveSteps) {
+    moveFinish();
+  }
+}
+
+/***
+ * Hand a move over to the motor interrupts. They brake so as to be at
+ * exitSpeed when positionCount reaches steps, then set motorsMoveDone.
+ * The speed targets, profile and directions should already be set. The
+ * move counts as a straight and takes the place of any segment being
+ * made. Segments still in the queue follow on after it.
+ *
+ * This returns at once. Poll motorsMoveDone or call motorsWaitForMove()
+ * to know when the move is over.
+ */
+void motorsMove(long steps, int exitSpeed) {
+  uint8_t oldSREG = SREG;
+  cli();
+  moveSegment.type = SEGMENT_STRAIGHT;
+  moveSteps = steps;
+  moveExitSpeed = exitSpeed;
+  moveBrakingStart();
+  moveBraking = false;
+  moveActive = true;
+  motorsMoveDone = false;
+  moveStep();
+  SREG = oldSREG;
+}
+
+// wait for the move, and everything in the motion queue, to be done
+void motorsWaitForMove() {
+  while (!motorsMoveDone) {
+    ; // do nothing
+  }
+}
+
+/***
+ * Add a segment to the motion queue. If the motors have nothing to do it
+ * is started at once. The position count starts again from zero as each
+ * segment starts.
+ *
+ * Returns false, and leaves the queue alone, when the queue is full.
+ */
+bool motorsQueueSegment(const MotionSegment &segment) {
+  bool added = true;
+  uint8_t oldSREG = SREG;
+  cli();
+  if (!moveActive) {
+    moveStart(segment);
+    moveStep();
+  } else if (moveQueue.full()) {
+    added = false;
+  } else {
+    moveQueue.add(segment);
+  }
+  SREG = oldSREG;
+  return added;
+}
+
+// the number of segments waiting behind the one being made
+unsigned char motorsQueueDepth() {
+  uint8_t oldSREG = SREG;
+  cli();
+  unsigned char depth = moveQueue.size();
+  SREG = oldSREG;
+  return depth;
+}
+
+// the type of the segment being made. SEGMENT_NONE when the queue is done
+unsigned char motorsCurrentSegment() {
+  uint8_t oldSREG = SREG;
+  cli();
+  unsigned char type = moveActive ? moveSegment.type : (unsigned char)SEGMENT_NONE;
+  SREG = oldSREG;
+  return type;
+}
+
+/***
+ * Segments started since the motors were last halted. Along with the
+ * queue depth, this tells the planner which of its segments is being made.
+ */
+unsigned int motorsSegmentCount() {
+  uint8_t oldSREG = SREG;
+  cli();
+  unsigned int count = moveSegmentCount;
+  SREG = oldSREG;
+  return count;
+}
+
+void motorRightUpdate() {
+
+  unsigned int timerInterval;
+
+  speedRight = profileStep(speedRight, speedTargetRight, motorsProfile, rampRight);
   speedRight = constrain(speedRight, 0, SPEED_TABLE_END);
   if (speedRight == 0) {
     timerInterval = MOTOR_IDLE_57Hz;
@@ -88,6 +310,7 @@ void motorRightUpdate() {
     offsetCount++;
     positionCount++;
     digitalWriteFast(STEPR, 0);
+    moveStep();
   }
   OCR1B += timerInterval;
 }
@@ -96,12 +319,7 @@ void motorRightUpdate() {
 void motorLeftupdate() {
   unsigned int timerInterval;
 
-  if (speedLeft < speedTargetLeft) {
-    speedLeft++;
-  }
-  if (speedLeft > speedTargetLeft) {
-    speedLeft--;
-  }
+  speedLeft = profileStep(speedLeft, speedTargetLeft, motorsProfile, rampLeft);
   speedLeft = constrain(speedLeft, 0, SPEED_TABLE_END);
   if (speedLeft == 0) {
     timerInterval = MOTOR_IDLE_51Hz;
@@ -114,12 +332,179 @@ void motorLeftupdate() {
     offsetCount++;
     positionCount++;
     digitalWriteFast(STEPL, 0);
+    moveStep();
   }
   ;
   OCR1A += timerInterval;
 }
 
 
+/***
+ * The DDA step generator.
+ *
+ * Each wheel has a velocity in steps per tick as a 0.32 fixed point
+ * fraction and its compare interrupt runs at the fixed DDA_TICK_HZ. Every
+ * tick the velocity is added to a phase accumulator and a step is made
+ * when that overflows. While the velocity is away from its target it moves
+ * by a fixed amount each tick, so the acceleration is constant in time and
+ * not only changed once a step. There is no table to run off the end of
+ * and the top speed is only limited by the tick rate.
+ *
+ * The rest of the code still gives speeds as table indexes. Under constant
+ * acceleration the index, the steps needed to stop, is proportional to the
+ * square of the velocity and that links the two. A new target index is
+ * turned into a velocity with a square root. The index the wheel is at is
+ * worked out again with two multiplies after each step while it is
+ * changing speed, so braking sums work as they always have. A speed
+ * written from outside the interrupt sets the velocity straight away.
+ *
+ * The acceleration is the table acceleration times the profile rate. For
+ * a jerk limited profile, profileStep() moves the rate on once a step just
+ * as it does for the table, so the braking sums still hold. A wheel
+ * starting from rest steps at once at the speed for index 1, which is
+ * what the table does too.
+ *
+ * Steps are made on a tick so they can be up to one tick early or late.
+ * With the default 10kHz that is 100us. Both wheels idle at the table
+ * rates when they are stopped.
+ */
+// the square of the velocity, in 0.16 steps per tick, for each table index
+const uint32_t DDA_INDEX_SQUARED = (2ULL * TABLE_ACCELERATION << 32) / ((unsigned long long)DDA_TICK_HZ * DDA_TICK_HZ);
+// the index for a velocity squared is (v * v >> 16) * DDA_INDEX_SCALE >> 16
+const unsigned int DDA_INDEX_SCALE = (1ULL << 32) / DDA_INDEX_SQUARED;
+// the velocity change per tick, in 0.32 steps per tick, for each 256th of the table acceleration
+const unsigned int DDA_ACCELERATION = ((unsigned long long)TABLE_ACCELERATION << 24) / ((unsigned long long)DDA_TICK_HZ * DDA_TICK_HZ);
+const unsigned int DDA_TICK = F_MOTOR_TIMER / DDA_TICK_HZ;
+// the velocity for index 1
+const uint32_t DDA_START = (uint32_t)accSqrt(DDA_INDEX_SQUARED) << 16;
+
+static_assert(DDA_SPEED_END < (1ULL << 32) / DDA_INDEX_SQUARED, "DDA_SPEED_END is faster than one step per tick");
+static_assert(DDA_INDEX_SQUARED >= (1UL << 16), "DDA_TICK_HZ is too high for DDA_INDEX_SCALE");
+
+struct DdaWheel {
+  uint32_t velocity;	// steps per tick in 0.32 fixed point
+  uint32_t target;	// the velocity for targetIndex
+  uint32_t phase;	// the part of a step made so far
+  int index;	// the speed index last given to the rest of the code
+  int targetIndex;
+  ProfileRamp ramp;	// only the rate is used
+};
+
+static DdaWheel ddaLeft;
+static DdaWheel ddaRight;
+
+// the largest r with r * r <= x
+static unsigned int ddaSqrt(uint32_t x) {
+  uint32_t result = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > x) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (x >= result + bit) {
+      x -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (unsigned int)result;
+}
+
+static uint32_t ddaVelocity(int index) {
+  return (uint32_t)ddaSqrt(index * DDA_INDEX_SQUARED) << 16;
+}
+
+/***
+ * One tick for a wheel. Returns true when it should step. speed and target
+ * are the wheel's speedLeft/speedRight and speedTargetLeft/speedTargetRight.
+ */
+static bool ddaTick(DdaWheel &wheel, volatile int &speed, int target, bool slow) {
+  if (speed != wheel.index) {
+    wheel.index = constrain(speed, 0, DDA_SPEED_END);
+    wheel.velocity = ddaVelocity(wheel.index);
+    speed = wheel.index;
+  }
+  if (target != wheel.targetIndex) {
+    wheel.targetIndex = constrain(target, 0, DDA_SPEED_END);
+    wheel.target = ddaVelocity(wheel.targetIndex);
+  }
+  bool ramping = wheel.velocity != wheel.target;
+  if (ramping) {
+    if (wheel.velocity == 0) {
+      wheel.velocity = DDA_START;
+      wheel.phase = 0xffffffff;
+    }
+    unsigned int rate = motorsProfile.rate;
+    if (motorsProfile.jerk != 0) {
+      rate = wheel.ramp.rate > PROFILE_RATE_MIN ? wheel.ramp.rate : PROFILE_RATE_MIN;
+    }
+    uint32_t change = (uint32_t)DDA_ACCELERATION * rate;
+    if (wheel.velocity < wheel.target) {
+      wheel.velocity = wheel.target - wheel.velocity > change ? wheel.velocity + change : wheel.target;
+    } else {
+      wheel.velocity = wheel.velocity - wheel.target > change ? wheel.velocity - change : wheel.target;
+    }
+  }
+  uint32_t velocity = wheel.velocity;
+  if (slow) {
+    velocity -= (velocity >> 3) - (velocity >> 6);	// 8/9 as for the table
+  }
+  uint32_t phase = wheel.phase + velocity;
+  bool step = phase < wheel.phase;
+  wheel.phase = phase;
+  if (ramping && wheel.velocity == wheel.target) {
+    wheel.index = wheel.targetIndex;
+    wheel.ramp.rate = PROFILE_RATE_MIN;
+    wheel.ramp.gain = 0;
+    speed = wheel.index;
+  } else if (ramping && step) {
+    profileStep(wheel.index, wheel.targetIndex, motorsProfile, wheel.ramp);
+    unsigned int v = wheel.velocity >> 16;
+    wheel.index = (unsigned int)((((uint32_t)v * v) >> 16) * DDA_INDEX_SCALE >> 16);
+    speed = wheel.index;
+  }
+  return step;
+}
+
+void motorLeftDda() {
+  unsigned int timerInterval = DDA_TICK;
+  if (ddaTick(ddaLeft, speedLeft, speedTargetLeft, slowLeftMotor)) {
+    digitalWriteFast(STEPL, 1);
+    offsetCount++;
+    positionCount++;
+    digitalWriteFast(STEPL, 0);
+    moveStep();
+  } else if (ddaLeft.velocity == 0 && ddaLeft.target == 0) {
+    timerInterval = MOTOR_IDLE_51Hz;
+  }
+  OCR1A += timerInterval;
+}
+
+void motorRightDda() {
+  unsigned int timerInterval = DDA_TICK;
+  if (ddaTick(ddaRight, speedRight, speedTargetRight, slowRightMotor)) {
+    digitalWriteFast(STEPR, 1);
+    offsetCount++;
+    positionCount++;
+    digitalWriteFast(STEPR, 0);
+    moveStep();
+  } else if (ddaRight.velocity == 0 && ddaRight.target == 0) {
+    timerInterval = MOTOR_IDLE_57Hz;
+  }
+  OCR1B += timerInterval;
+}
+
+#if MOTORS_DDA
+ISR(TIMER1_COMPA_vect) {      // interrupt service routine
+  motorLeftDda();
+}
+
+ISR(TIMER1_COMPB_vect) {      // interrupt service routine
+  motorRightDda();
+}
+#else
 ISR(TIMER1_COMPA_vect) {      // interrupt service routine
   motorLeftupdate();
 }
@@ -127,6 +512,7 @@ ISR(TIMER1_COMPA_vect) {      // interrupt service routine
 ISR(TIMER1_COMPB_vect) {      // interrupt service routine
   motorRightUpdate();
 }
+#endif
 
 // simply stop them moving. Current may still flow.
 void motorsHalt() {
@@ -136,6 +522,12 @@ void motorsHalt() {
   speedRight = 0;
   speedTargetLeft = 0;
   speedTargetRight = 0;
+  motorsProfile = PROFILE_TRAPEZOID;
+  moveActive = false;
+  moveSegment.type = SEGMENT_NONE;
+  moveQueue.clear();
+  moveSegmentCount = 0;
+  motorsMoveDone = true;
   SREG = oldSREG;
 }
 
@@ -165,27 +557,39 @@ void motorsWaitUntil(long targetSteps) {
   }
 }
 
+// brake to a stop at the target step count from whatever the motors are doing
 void motorsStopAt(long target) {
-  bool done = false;
-  while (!done) {
-    int remaining = target - getStepCount();
-    int speed = getVolatile(speedRight) + getVolatile(speedLeft);
-    if (remaining < speed) {
-      done  = true;
-    }
-  }
-  // hit the brakes
-  setVolatile(speedTargetRight, 1);
-  setVolatile(speedTargetLeft, 1);
-  done = false;
-  while (!done) {
-    done =  getStepCount() >= target;
-  }
-  // make sure they stop completely
-  setVolatile(speedTargetRight, 0);
-  setVolatile(speedTargetLeft, 0);
-  setVolatile(speedRight, 0);
-  setVolatile(speedLeft, 0);
+  motorsMove(target, 0);
+  motorsWaitForMove();
+}
+
+/***
+ * Carry on at up to maxSpeed and be at exitSpeed on reaching the target
+ * step count. As for motorsStopAt(), the target is counted from the last
+ * counter reset, so however long the caller took to get here, the move
+ * still ends at the same place.
+ */
+void motorsMoveTo(long target, int maxSpeed, int exitSpeed) {
+  noInterrupts();
+  speedTargetLeft = maxSpeed;
+  speedTargetRight = maxSpeed;
+  interrupts();
+  motorsMove(target, exitSpeed);
+  motorsWaitForMove();
+}
+
+/***
+ * True if there is still room to slow from the present speeds to the
+ * given one by the target step count. Any later and the move would have
+ * to cut the speed at the end, which the motors may not follow.
+ */
+bool motorsCanSlowTo(long target, int speed) {
+  uint8_t oldSREG = SREG;
+  cli();
+  long braking = profileSteps(speedLeft - speed, motorsProfile) + profileSteps(speedRight - speed, motorsProfile);
+  long remaining = target - positionCount;
+  SREG = oldSREG;
+  return remaining >= braking;
 }
 
 
@@ -58,6 +58,8 @@
  * a training platform, not an international contest entry.
  *
  */
+#include "profile.h"
+
 #define SET_RIGHT_FD() digitalWriteFast(DIRR, 1)
 #define SET_RIGHT_BK() digitalWriteFast(DIRR, 0)
 #define SET_LEFT_FD() digitalWriteFast(DIRL, 0)
@@ -74,6 +76,36 @@ extern volatile int speedRight;
 extern  bool slowLeftMotor;
 extern bool slowRightMotor; // flags indicate whether slowing left or right motor for steering
 
+extern MotionProfile motorsProfile;
+extern volatile bool motorsMoveDone;	// set by the interrupts when a move and the motion queue are done
+
+/***
+ * The motion queue holds the segments of a path for the motor interrupts
+ * to make one after the other. The interrupts start the next segment on
+ * the step that ends the one before so the main loop is free to plan
+ * ahead, or run the floods, while the mouse moves.
+ *
+ * A segment starts at whatever speed the last one left the motors at.
+ * Give each segment the exit speed that the next one expects to start at
+ * and the handover is smooth. A change of direction, as from a straight
+ * to a spin, needs an exit speed of zero.
+ */
+enum {
+  SEGMENT_NONE, SEGMENT_STRAIGHT, SEGMENT_SPIN, SEGMENT_ARC
+};
+
+struct MotionSegment {
+  unsigned char type;
+  unsigned char direction;	// FORWARD or REVERSE for a straight. LEFT or RIGHT for a spin or an arc
+  long steps;	// by both motors. For an arc, the phase 2 steps. See turnSmooth()
+  int maxSpeed;	// not used by an arc
+  int exitSpeed;	// an arc is entered and left at this speed
+  MotionProfile profile;	// an arc should use PROFILE_TRAPEZOID
+};
+
+// segments waiting behind the one being made
+#define MOTION_QUEUE_SIZE 4
+
 void motorsInit();
 void setMicrostepMode(int mode);
 void motorsHalt();
@@ -83,10 +115,21 @@ void motorsResetCounters();
 long getStepCount();
 void motorsSetDirection(int direction);
 
+void motorsMove(long steps, int exitSpeed);
+void motorsWaitForMove();
+bool motorsQueueSegment(const MotionSegment &segment);
+unsigned char motorsQueueDepth();
+unsigned char motorsCurrentSegment();
+unsigned int motorsSegmentCount();
 void motorsStopAt(long distance);
+void motorsMoveTo(long target, int maxSpeed, int exitSpeed);
+bool motorsCanSlowTo(long target, int speed);
 void motorsWaitUntil(long distance);
 void motorRightUpdate();
 void motorLeftupdate();
+// the DDA generator. The interrupts call these in place of the two above when MOTORS_DDA is 1
+void motorRightDda();
+void motorLeftDda();
 
 
 #endif /* MOTORS_H_ */
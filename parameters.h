@@ -30,9 +30,38 @@
 // bigger is always faster
 // conveniently this index is also the number of steps needed to come to rest
 #define SPEEDMAX_EXPLORE      225		//	 must be slow enough to stop easily in 90mm or less
-#define SPEEDMAX_STRAIGHT     225		// must be able to get down to smooth turn speed in 20mm
+#define SPEEDMAX_STRAIGHT     225		// speed runs brake for each turn over the whole straight
 #define SPEEDMAX_SPIN_TURN    225
 #define SPEEDMAX_SMOOTH_TURN   70		// affects turn radius
+#define SPEEDMAX_DIAGONAL     150		// diagonals pass close to the posts
+
+// the search slows to this in a cell before one where it expects to turn. From
+// here it can brake to SPEEDMAX_SMOOTH_TURN between the cell boundary and the
+// start of the turn, less 10mm for the time taken to decide at the boundary
+#define SPEEDMAX_SEARCH_TURN  (SPEEDMAX_SMOOTH_TURN + MM(90 - SMOOTH_TURN_OFFSET - 10) / 2)
+// search straights through visited cells. See mouse.fastKnown
+#define SPEEDMAX_SEARCH_KNOWN 400
+
+// the jerk limited profile for the speed run straights. See profile.h
+#define SCURVE_ACCELERATION  1800		// peak acceleration in mm/s/s
+#define SCURVE_RAMP            10		// mm over which the acceleration builds up and dies away
+
+// smooth turn phase lengths in steps. See turnSmooth()
+#define SMOOTH_TURN_PHASE1    220		// adjust for radius
+#define SMOOTH_TURN_PHASE2    500		// adjust for angle
+#define SMOOTH_TURN_45_PHASE2  150		// adjust for angle
+#define SMOOTH_TURN_135_PHASE2 890		// adjust for angle
+// distance in mm from the corner to the start and the end of a smooth turn.
+// The corner is the cell centre for a 90 degree turn and a wall midpoint for the others
+#define SMOOTH_TURN_OFFSET     70
+#define SMOOTH_TURN_45_OFFSET  37
+#define SMOOTH_TURN_135_OFFSET 153
+
+// smooth turns the search makes in a row before it stops to line up on a front wall
+#define SEARCH_SMOOTH_TURNS_MAX  4
+
+// cells of travel the exploring search will make to shorten the best possible route by one cell
+#define EXPLORE_GAIN_WEIGHT     32
 
 // the steering error needs to be constrained to keep from over correcting
 #define STEERING_ERROR_MAX			32
@@ -41,6 +70,13 @@
 
 #define MOTOR_IDLE_51Hz (F_MOTOR_TIMER/51)    // motor idle frequency is 51Hz
 #define MOTOR_IDLE_57Hz (F_MOTOR_TIMER/57)    // motor idle frequency is 57Hz
+// the step generator. 0 times each step from the acceleration table. 1 uses
+// the fixed rate DDA generator. See motors.cpp
+#ifndef MOTORS_DDA
+#define MOTORS_DDA 0
+#endif
+#define DDA_TICK_HZ   10000		// DDA updates per second for each wheel
+#define DDA_SPEED_END  4095		// the fastest speed index for the DDA. Twice the table top speed
 const int SYSTICK_FREQUENCY = 250;
 // values are sum of left and right motor steps
 #define STEPS_FOR_ONE_METER  (8248L)
@@ -50,6 +86,8 @@ const int SYSTICK_FREQUENCY = 250;
 #define MM(X) (((X) * STEPS_FOR_ONE_METER)/1000L)
 // convert angles in degrees to step counts
 #define DEG(X) (((X) * STEPS_FOR_360DEG )/360L)
+// length in mm of a diagonal run between wall midpoints that are X apart
+#define DIAGONAL_MM(X) (((X) * 1273L)/10L)
 
 
 // Calibration values are the raw reading from the sensor
@@ -0,0 +1,631 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#include "planner.h"
+#include "maze.h"
+#include "acctable.h"
+#include "parameters.h"
+#include "profile.h"
+#include "runplan.h"
+#include "src/hardware/hardware.h"
+#include "src/hardware/mouse.h"
+
+/***
+ * For diagonal runs, each cell also keeps the first move of the quickest
+ * route from it. The top two bits are the kind of move, the next two the
+ * direction of its first step and the low four bits its length in cells.
+ */
+#define LINK_STOP        0x00	// a target cell
+#define LINK_STRAIGHT    0x40
+#define LINK_RIGHT       0xC0	// a staircase that steps right after its first step
+#define LINK_LEFT        0x80	// a staircase that steps left after its first step
+#define LINK_LENGTH_MAX  15
+
+static constexpr unsigned char (&runLink)[MAZE_CELLS] = mazeScratch.planner.link;
+
+#if QUEUE_DEBUG
+unsigned long plannerRemoved;
+#endif
+
+/***
+ * The cells waiting to be worked on by the floods, kept in the scratch
+ * memory with the times. The waiting bitmap keeps a cell from being in
+ * the queue twice so it can never hold more than MAZE_CELLS entries.
+ */
+class PlannerQueue {
+public:
+  PlannerQueue() : mHead(0), mItemCount(0) {
+    for (int i = 0; i < (MAZE_CELLS + 7) / 8; i++) {
+      mazeScratch.planner.waiting[i] = 0;
+    }
+  }
+
+  int size() {
+    return mItemCount;
+  }
+
+  // add a cell unless it is already waiting
+  void add(cell_t cell) {
+    unsigned char &waiting = mazeScratch.planner.waiting[cell >> 3];
+    if (waiting & (1 << (cell & 0x07))) {
+      return;
+    }
+    waiting |= (1 << (cell & 0x07));
+    int tail = mHead + mItemCount;
+    if (tail >= MAZE_CELLS) {
+      tail -= MAZE_CELLS;
+    }
+    mazeScratch.planner.queue[tail] = cell;
+    ++mItemCount;
+  }
+
+  cell_t head() {
+    cell_t cell = mazeScratch.planner.queue[mHead];
+    if (++mHead >= MAZE_CELLS) {
+      mHead = 0;
+    }
+    --mItemCount;
+    mazeScratch.planner.waiting[cell >> 3] &= ~(1 << (cell & 0x07));
+#if QUEUE_DEBUG
+    ++plannerRemoved;
+#endif
+    return cell;
+  }
+
+private:
+  int mHead;
+  int mItemCount;
+};
+
+// the motion model. Times are in ticks of TIME_TICK_MS
+static unsigned int straightTime[MAX_SIDE];  // straights of 1 or more cells, turn speed at each end
+static unsigned int turnTime;          // a single 90 degree turn
+static unsigned int turnTimes[4];      // diagonal runs. Turns of 0, 45, 90 and 135 degrees
+static unsigned int diagonalTime[LINK_LENGTH_MAX + 1];  // diagonal runs. Staircases of 3 or more cells
+static unsigned char modelStyle = 0xff;
+static bool modelScurve;               // the straights are timed with PROFILE_SCURVE
+static unsigned char floodStyle;       // the style of the last plannerFlood()
+static bool floodKnownOnly;            // the last plannerFlood() used known passages only
+
+
+/***
+ * The time, in timer counts, to move the given number of steps when
+ * starting and finishing at the given speeds with the given profile.
+ *
+ * This follows the same rules as move() and the motor ISRs. Both wheels
+ * step together so only one wheel need be followed and it makes half of
+ * the steps. The speed is moved on by profileStep() for each step and
+ * braking starts when the remaining steps are no more than profileSteps()
+ * gives for getting down to the exit speed. The motors always brake to a
+ * speed of 1 when they are coming to a halt.
+ *
+ * Only the speed ramps are stepped through. The time at the peak speed is
+ * a single multiplication.
+ */
+static unsigned long profileTime(long steps, int entrySpeed, int maxSpeed, int exitSpeed,
+                                 const MotionProfile &profile) {
+  long wheelSteps = steps / 2;
+  int lowest = (exitSpeed > 0) ? exitSpeed : 1;
+  ProfileRamp ramp = {0, 0, false, 0};
+  unsigned long time = 0;
+  int speed = entrySpeed;
+  while (wheelSteps > 0 && wheelSteps >= profileSteps(speed - exitSpeed, profile)) {
+    long cruiseSteps = wheelSteps - profileSteps(speed - exitSpeed, profile);
+    if (speed == maxSpeed && cruiseSteps > 0) {
+      time += cruiseSteps * accTable(speed);
+      wheelSteps -= cruiseSteps;
+      continue;
+    }
+    speed = profileStep(speed, maxSpeed, profile, ramp);
+    time += accTable(speed);
+    wheelSteps--;
+  }
+  while (wheelSteps > 0) {
+    speed = profileStep(speed, lowest, profile, ramp);
+    time += accTable(speed);
+    wheelSteps--;
+  }
+  return time;
+}
+
+static unsigned int toTicks(unsigned long counts) {
+  return counts / (F_COUNTER / 1000 * TIME_TICK_MS);
+}
+
+// the time, in timer counts, for a smooth turn with the given phase 2 length
+static unsigned long smoothTurnTime(int phase2) {
+  int speed = SPEEDMAX_SMOOTH_TURN;
+  return profileTime(2 * SMOOTH_TURN_PHASE1 + phase2, speed, speed, speed, PROFILE_TRAPEZOID);
+}
+
+/***
+ * Work out the time for every possible straight and for a turn in the given
+ * style of run. Each straight starts and ends at the speed used for turning.
+ *
+ * For in-place runs, the mouse comes to a halt at the end of each straight
+ * and the turn is the same spin used by turnIP90L() and turnIP90R().
+ *
+ * For smooth runs, the straights start and finish at SPEEDMAX_SMOOTH_TURN.
+ * The wheel speeds change during a smooth turn but their total step rate
+ * stays close to the entry speed so the turn is taken as all three of its
+ * phases driven at that speed.
+ *
+ * Diagonal runs use the smooth straights and also need the 45 and 135
+ * degree turns and the staircases. A staircase is half a cell to the
+ * first wall it crosses, the diagonal from there to the last one and
+ * half a cell on to the final cell centre, with a 45 degree turn at each
+ * end of the diagonal.
+ *
+ * The straights follow runProfile() and the turns always use the
+ * trapezoid profile as the motion code does.
+ *
+ * The tables are only rebuilt when the style or the profile changes.
+ */
+static void plannerModel(unsigned char runStyle) {
+  if (runStyle == modelStyle && mouse.scurveRuns == modelScurve) {
+    return;
+  }
+  modelStyle = runStyle;
+  modelScurve = mouse.scurveRuns;
+  int turnSpeed;
+  unsigned long turnCounts;
+  if (runStyle == RUN_INPLACE) {
+    turnSpeed = 0;
+    turnCounts = profileTime(DEG(90), 0, SPEEDMAX_SPIN_TURN, 0, PROFILE_TRAPEZOID);
+  } else {
+    turnSpeed = SPEEDMAX_SMOOTH_TURN;
+    turnCounts = smoothTurnTime(SMOOTH_TURN_PHASE2);
+  }
+  turnTime = toTicks(turnCounts);
+  straightTime[0] = 0;
+  for (int cells = 1; cells < MAX_SIDE; cells++) {
+    unsigned long counts = profileTime(cells * MM(180), turnSpeed, SPEEDMAX_STRAIGHT, turnSpeed, runProfile());
+    straightTime[cells] = toTicks(counts);
+  }
+  if (runStyle == RUN_DIAGONAL) {
+    turnTimes[0] = 0;
+    turnTimes[1] = toTicks(smoothTurnTime(SMOOTH_TURN_45_PHASE2));
+    turnTimes[2] = turnTime;
+    turnTimes[3] = toTicks(smoothTurnTime(SMOOTH_TURN_135_PHASE2));
+    for (int cells = 3; cells <= LINK_LENGTH_MAX; cells++) {
+      unsigned long counts = profileTime(MM(180), turnSpeed, turnSpeed, turnSpeed, runProfile());
+      counts += profileTime(MM(DIAGONAL_MM(cells - 1)), turnSpeed, SPEEDMAX_DIAGONAL, turnSpeed, runProfile());
+      diagonalTime[cells] = toTicks(counts) + 2 * turnTimes[1];
+    }
+  }
+}
+
+static unsigned char linkKind(unsigned char link) {
+  return link & 0xC0;
+}
+
+static unsigned char linkDirection(unsigned char link) {
+  return (link >> 4) & 0x03;
+}
+
+static unsigned char linkLength(unsigned char link) {
+  return link & 0x0F;
+}
+
+/***
+ * The extra time needed where a move that arrives along arrivalLine, with
+ * its last step in the direction lastStep, is followed by the move in
+ * link. Lines are in eighths of a turn clockwise from north so straights
+ * have even lines and the diagonals of staircases have odd ones.
+ *
+ * A staircase already includes the 45 degree turns on to and off its
+ * diagonal. Where it meets the other move at a wall midpoint instead, in a
+ * 135 degree turn or a 90 degree turn between two diagonals, those turns
+ * are taken off again.
+ *
+ * Returns false if the mouse would have to double back.
+ */
+static bool linkTurn(unsigned char lastStep, unsigned char arrivalLine, unsigned char link, long &extra) {
+  extra = 0;
+  unsigned char kind = linkKind(link);
+  if (kind == LINK_STOP) {
+    return true;
+  }
+  unsigned char first = linkDirection(link);
+  if (first == DtoB[lastStep]) {
+    return false;
+  }
+  if (first == lastStep) {
+    return true;
+  }
+  unsigned char line = 2 * first;
+  if (kind == LINK_RIGHT) {
+    line += 1;
+  } else if (kind == LINK_LEFT) {
+    line -= 1;
+  }
+  unsigned char angle = (line - arrivalLine) & 0x07;
+  if (angle > 4) {
+    angle = 8 - angle;
+  }
+  if (angle == 4) {
+    return false;
+  }
+  extra = turnTimes[angle];
+  if (arrivalLine & 1) {
+    extra -= turnTimes[1];
+  }
+  if (kind != LINK_STRAIGHT) {
+    extra -= turnTimes[1];
+  }
+  return true;
+}
+
+// the passages the last plannerFlood() could use
+static bool plannerExit(cell_t cell, unsigned char direction) {
+  return floodKnownOnly ? hasKnownExit(cell, direction) : hasExit(cell, direction);
+}
+
+static void plannerImprove(PlannerQueue &queue, cell_t cell, long time, unsigned char link) {
+  if (time >= runTime[cell]) {
+    return;
+  }
+  runTime[cell] = time;
+  runLink[cell] = link;
+  queue.add(cell);
+}
+
+/***
+ * The flood for diagonal runs. It works like plannerFlood() but as well as
+ * the straights there are staircases, where the steps alternate between
+ * two directions. The mouse runs a staircase on a diagonal through the
+ * midpoints of the walls it crosses rather than turning in every cell.
+ *
+ * On a diagonal run, the time for a turn depends on both of the moves it
+ * joins. A turn from a straight on to a diagonal may be 45 or 135 degrees
+ * and two diagonals can meet at 90 degrees. So each cell also records the
+ * move that gives it its time in runLink[] and, when the flood works back
+ * to a cell from there, the turn between its move and that one is added.
+ *
+ * There is still only one time for each cell however the mouse arrives
+ * so the route found is not always the quickest possible. It is always
+ * a real route though, and the time of each cell is always more than the
+ * time of the cell its move leads to so the moves cannot form a loop.
+ *
+ * The lengths are held in four bits so straights are limited to
+ * LINK_LENGTH_MAX cells. Staircases may be from 3 to LINK_LENGTH_MAX
+ * cells. Longer ones are made from more than one move.
+ */
+static void plannerFloodDiagonal(const CellSet &targets) {
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    runTime[i] = MAX_TIME;
+  }
+  PlannerQueue queue;
+  for (unsigned char i = 0; i < targets.count; i++) {
+    runTime[targets.cells[i]] = 0;
+    runLink[targets.cells[i]] = LINK_STOP;
+    queue.add(targets.cells[i]);
+  }
+  while (queue.size() > 0) {
+    cell_t here = queue.head();
+    unsigned char link = runLink[here];
+    long extra;
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      // straights that arrive here heading in this direction
+      if (linkTurn(direction, 2 * direction, link, extra)) {
+        long baseTime = runTime[here] + extra;
+        cell_t cell = here;
+        for (int cells = 1; cells < MAX_SIDE && cells <= LINK_LENGTH_MAX; cells++) {
+          if (!plannerExit(cell, DtoB[direction])) {
+            break;
+          }
+          cell = neighbour(cell, DtoB[direction]);
+          plannerImprove(queue, cell, baseTime + straightTime[cells], LINK_STRAIGHT | (direction << 4) | cells);
+        }
+      }
+      // staircases whose last step is in this direction
+      for (unsigned char side = 0; side < 2; side++) {
+        unsigned char other = side ? DtoL[direction] : DtoR[direction];
+        unsigned char line = (2 * direction + (side ? 7 : 1)) & 0x07;
+        if (!linkTurn(direction, line, link, extra)) {
+          continue;
+        }
+        long baseTime = runTime[here] + extra;
+        cell_t cell = here;
+        unsigned char step = direction;
+        for (int cells = 1; cells <= LINK_LENGTH_MAX; cells++) {
+          if (!plannerExit(cell, DtoB[step])) {
+            break;
+          }
+          cell = neighbour(cell, DtoB[step]);
+          unsigned char next = (step == direction) ? other : direction;
+          if (cells >= 3) {
+            unsigned char kind = (next == DtoR[step]) ? LINK_RIGHT : LINK_LEFT;
+            plannerImprove(queue, cell, baseTime + diagonalTime[cells], kind | (step << 4) | cells);
+          }
+          step = next;
+        }
+      }
+    }
+  }
+}
+
+/***
+ * Flood the maze with the time needed to drive from each cell to the
+ * nearest target.
+ *
+ * Moves are whole straights from one turn to the next. The time for a cell
+ * is the time to turn there, drive a straight of any length in any open
+ * direction and then carry on from the cell at the far end. Because a
+ * straight of any length is a single move, long straights are cheaper per
+ * cell than short ones and every turn is paid for.
+ *
+ * Strictly, the time from a cell depends on the direction the mouse is
+ * facing. It does not need to be stored here though. Moves are always
+ * followed by a turn and two moves in a row along the same line are always
+ * slower than the single longer straight. The quickest route found this
+ * way always alternates between the two axes and so it is the same one a
+ * planner tracking the heading in every cell would find. That takes a
+ * quarter of the memory.
+ *
+ * Like mazeFlood(), cells are worked from a queue. Here, a cell may be
+ * improved more than once so it is put back on the queue if it is not
+ * already waiting there. See PlannerQueue.
+ *
+ * The times, and everything else the planner floods need, share their
+ * memory with cost[] and costKnown[], which are lost.
+ *
+ * Diagonal runs are flooded by plannerFloodDiagonal().
+ *
+ * With knownOnly set, only passages the mouse has seen are used, as in
+ * mazeFloodKnown(), so that a speed run never relies on walls it has not
+ * seen. plannerDirection() and plannerPathGenerate() follow the same
+ * passages as the flood.
+ *
+ * @param targets - the cells from which all times are calculated
+ * @param runStyle - RUN_INPLACE, RUN_SMOOTH or RUN_DIAGONAL
+ * @param knownOnly - unseen walls count as closed
+ */
+void plannerFlood(const CellSet &targets, unsigned char runStyle, bool knownOnly) {
+  plannerModel(runStyle);
+  floodStyle = runStyle;
+  floodKnownOnly = knownOnly;
+  mazeCostsLost();
+  if (runStyle == RUN_DIAGONAL) {
+    plannerFloodDiagonal(targets);
+    return;
+  }
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    runTime[i] = MAX_TIME;
+  }
+  PlannerQueue queue;
+  for (unsigned char i = 0; i < targets.count; i++) {
+    runTime[targets.cells[i]] = 0;
+    queue.add(targets.cells[i]);
+  }
+  while (queue.size() > 0) {
+    cell_t here = queue.head();
+    unsigned long baseTime = (unsigned long)runTime[here] + turnTime;
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      cell_t cell = here;
+      for (int cells = 1; cells < MAX_SIDE && plannerExit(cell, direction); cells++) {
+        cell = neighbour(cell, direction);
+        unsigned long newTime = baseTime + straightTime[cells];
+        if (newTime < runTime[cell]) {
+          runTime[cell] = newTime;
+          queue.add(cell);
+        }
+      }
+    }
+  }
+}
+
+/***
+ * Find the quickest straight from a cell, taking account of any turn
+ * needed to face along it. Directions are tried ahead first, then right,
+ * left and behind so that ahead is preferred when times are equal.
+ *
+ * Assumes the maze has been flooded with plannerFlood().
+ *
+ * Returns the direction and sets length to the number of cells in the
+ * straight. If there is no route, length is zero and the heading is
+ * returned unchanged.
+ */
+static unsigned char plannerBestMove(cell_t cell, unsigned char heading, int &length) {
+  const unsigned char order[] = {0, 1, 3, 2};
+  unsigned long bestTime = MAX_TIME;
+  unsigned char bestDirection = heading;
+  length = 0;
+  for (unsigned char i = 0; i < 4; i++) {
+    unsigned char direction = (heading + order[i]) & 0x03;
+    unsigned long penalty = 0;
+    if (order[i] == 2) {
+      penalty = 2 * turnTime;
+    } else if (order[i] != 0) {
+      penalty = turnTime;
+    }
+    cell_t next = cell;
+    for (int cells = 1; cells < MAX_SIDE && plannerExit(next, direction); cells++) {
+      next = neighbour(next, direction);
+      if (runTime[next] == MAX_TIME) {
+        continue;
+      }
+      unsigned long time = penalty + straightTime[cells] + runTime[next];
+      if (time < bestTime) {
+        bestTime = time;
+        bestDirection = direction;
+        length = cells;
+      }
+    }
+  }
+  return bestDirection;
+}
+
+/***
+ * The direction the mouse should face to start the quickest route from
+ * the given cell. Used in the same way as directionToSmallest().
+ */
+unsigned char plannerDirection(cell_t cell, unsigned char heading) {
+  if (floodStyle == RUN_DIAGONAL) {
+    if (runTime[cell] == MAX_TIME || linkKind(runLink[cell]) == LINK_STOP) {
+      return heading;
+    }
+    return linkDirection(runLink[cell]);
+  }
+  int length;
+  return plannerBestMove(cell, heading, length);
+}
+
+/***
+ * Assumes the maze has been flooded with plannerFlood().
+ *
+ * Generates the quickest path from the start cell into path[] in exactly the
+ * same format as pathGenerate() so that it can be run by the same code.
+ * As there, the mouse is assumed to be facing in the direction given by
+ * plannerDirection() for the start cell and a heading of NORTH.
+ *
+ * After a diagonal flood, the path follows the moves in runLink[] and
+ * each staircase appears as alternating turns.
+ *
+ * Returns true if every cell on the path has been visited.
+ */
+bool plannerPathGenerate(cell_t startCell) {
+  bool solved = true;
+  cell_t cell = startCell;
+  unsigned char heading = plannerDirection(cell, NORTH);
+  int pathIndex = 0;
+  pathStyle = PATH_NONE;
+  path[pathIndex++] = 'B';
+  while (runTime[cell] != 0 && pathIndex < MAZE_CELLS - 6) {
+    int length = 0;
+    unsigned char direction = heading;
+    unsigned char other = heading;
+    bool staircase = false;
+    if (floodStyle == RUN_DIAGONAL) {
+      unsigned char link = runLink[cell];
+      if (runTime[cell] != MAX_TIME) {
+        length = linkLength(link);
+      }
+      direction = linkDirection(link);
+      staircase = linkKind(link) != LINK_STRAIGHT;
+      other = (linkKind(link) == LINK_RIGHT) ? DtoR[direction] : DtoL[direction];
+    } else {
+      direction = plannerBestMove(cell, heading, length);
+    }
+    if (length == 0) {
+      solved = false;
+      break;
+    }
+    for (int i = 0; i < length && pathIndex < MAZE_CELLS - 6; i++) {
+      char cmd = 'F';
+      if (direction == DtoR[heading]) {
+        cmd = 'R';
+      } else if (direction == DtoL[heading]) {
+        cmd = 'L';
+      } else if (direction == DtoB[heading]) {
+        cmd = 'A';
+      }
+      heading = direction;
+      cell = neighbour(cell, heading);
+      if ((walls[cell] & VISITED) != VISITED) {
+        solved = false;
+      }
+      path[pathIndex++] = cmd;
+      if (staircase) {
+        direction = other;
+        other = heading;
+      }
+    }
+  }
+  path[pathIndex++] = 'S';
+  path[pathIndex] = '\0';
+  pathEnd = cell;
+  return solved;
+}
+
+/***
+ * The time, in milliseconds, to run the moves that runPlanNext() makes
+ * from a path string. Used for diagonal runs where the straights and
+ * diagonals cannot be found just by counting cells.
+ */
+static unsigned long plannerPlanTime(const char *pathString, unsigned char runStyle) {
+  RunPlan plan;
+  unsigned long counts = 0;
+  runPlanBegin(plan, pathString, runStyle);
+  while (runPlanNext(plan)) {
+    for (unsigned char i = 0; i < plan.count; i++) {
+      const RunMove &move = plan.moves[i];
+      switch (move.type) {
+        case MOVE_STRAIGHT:
+          counts += profileTime(MM((long)move.length), move.entrySpeed, SPEEDMAX_STRAIGHT, move.exitSpeed, runProfile());
+          break;
+        case MOVE_DIAGONAL:
+          counts += profileTime(MM((long)move.length), move.entrySpeed, SPEEDMAX_DIAGONAL, move.exitSpeed, runProfile());
+          break;
+        case MOVE_IP90R:
+        case MOVE_IP90L:
+          counts += profileTime(DEG(90), 0, SPEEDMAX_SPIN_TURN, 0, PROFILE_TRAPEZOID);
+          break;
+        case MOVE_IP180:
+          counts += profileTime(DEG(180), 0, SPEEDMAX_SPIN_TURN, 0, PROFILE_TRAPEZOID);
+          break;
+        case MOVE_SS45R:
+        case MOVE_SS45L:
+          counts += smoothTurnTime(SMOOTH_TURN_45_PHASE2);
+          break;
+        case MOVE_SS135R:
+        case MOVE_SS135L:
+          counts += smoothTurnTime(SMOOTH_TURN_135_PHASE2);
+          break;
+        default:
+          counts += smoothTurnTime(SMOOTH_TURN_PHASE2);
+          break;
+      }
+    }
+  }
+  return counts / (F_COUNTER / 1000);
+}
+
+/***
+ * Estimate the time, in milliseconds, needed to run any path string in the
+ * given style using the same motion model as the planner. This lets paths
+ * from different planners be compared without running them.
+ */
+unsigned long plannerPathTime(const char *pathString, unsigned char runStyle) {
+  if (runStyle == RUN_DIAGONAL) {
+    return plannerPlanTime(pathString, runStyle);
+  }
+  plannerModel(runStyle);
+  unsigned long time = 0;
+  int cells = 0;
+  for (int i = 0; pathString[i]; i++) {
+    char c = pathString[i];
+    if (c == 'F' || c == 'R' || c == 'L' || c == 'A') {
+      if (c != 'F') {
+        time += straightTime[min(cells, MAX_SIDE - 1)];
+        time += (c == 'A') ? 2 * turnTime : turnTime;
+        cells = 0;
+      }
+      cells++;
+    }
+  }
+  time += straightTime[min(cells, MAX_SIDE - 1)];
+  return time * TIME_TICK_MS;
+}
@@ -0,0 +1,68 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "maze.h"
+
+/***
+ * The planner floods the maze with estimated running times rather than
+ * cell counts so that a speed run can choose the route that is quickest
+ * to drive instead of the one with fewest cells.
+ *
+ * Times are worked out from the acceleration table and the speed limits
+ * in parameters.h so they follow any changes to the motion settings.
+ *
+ * Times in runTime[] are in ticks of TIME_TICK_MS milliseconds so that the
+ * slowest runs still fit in 16 bits.
+ *
+ * A diagonal run can also cut through staircases on diagonal straights
+ * that join the midpoints of the walls it passes. See plannerFlood().
+ */
+
+#define TIME_TICK_MS 4
+#define MAX_TIME 0xFFFF
+
+enum {
+  RUN_INPLACE,   // stop and spin at every turn
+  RUN_SMOOTH,    // slow to the smooth turn speed at every turn
+  RUN_DIAGONAL   // smooth turns with diagonals through the staircases
+};
+
+// the planner times share their memory with the floods. See maze.h
+static constexpr unsigned int (&runTime)[MAZE_CELLS] = mazeScratch.planner.time;
+
+#if QUEUE_DEBUG
+// cells taken from the planner queue, counted as Queue counts its removals
+extern unsigned long plannerRemoved;
+#endif
+
+void plannerFlood(const CellSet &targets, unsigned char runStyle, bool knownOnly = false);
+unsigned char plannerDirection(cell_t cell, unsigned char heading);
+bool plannerPathGenerate(cell_t startCell);
+unsigned long plannerPathTime(const char *pathString, unsigned char runStyle);
+
+#endif //PLANNER_H
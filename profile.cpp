@@ -0,0 +1,83 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#include "profile.h"
+
+/***
+ * The number of steps one motor needs to change its speed by the given
+ * number of table entries, starting and finishing with no acceleration.
+ * The motor interrupts use this to decide when to start braking.
+ *
+ * For the trapezoid profile, each entry takes 256 / rate steps and at
+ * the table acceleration the steps are just the change in index. That
+ * case is checked first since the motor interrupts call this.
+ *
+ * A jerk limited profile builds the rate up from PROFILE_RATE_MIN a
+ * jerk at a time and lets it die away in the reverse order. The two ramps
+ * are added a step from each end at a time until they cover the change or
+ * the rate reaches its peak. Whatever is left is covered at the peak rate.
+ * That is never more than a few dozen passes for a sensible profile.
+ */
+long profileSteps(int change, const MotionProfile &profile) {
+  if (change <= 0) {
+    return 0;
+  }
+  if (profile.jerk == 0 && profile.rate == 256) {
+    return change;
+  }
+  ProfileBraking braking;
+  profileBrakingStart(braking, change, profile);
+  return braking.steps;
+}
+
+/***
+ * Work out the braking steps for a speed change from scratch, as
+ * profileSteps() does, and keep the parts of the count so that
+ * profileBraking() can follow the speed from there. The motor interrupts
+ * call this once as each move starts.
+ */
+void profileBrakingStart(ProfileBraking &braking, int change, const MotionProfile &profile) {
+  long target = (change > 0) ? (long)change << 8 : 0;
+  braking.change = change;
+  braking.steps = 0;
+  braking.rate = PROFILE_RATE_MIN;
+  braking.ramp = 0;
+  braking.peak = 0;
+  if (profile.jerk > 0) {
+    while (braking.rate < profile.rate && braking.ramp < target) {
+      braking.rate += profile.jerk;
+      braking.ramp += 2L * braking.rate;
+      braking.steps += 2;
+    }
+    if (braking.rate < profile.rate) {
+      return;
+    }
+  }
+  if (braking.ramp < target) {
+    long peakSteps = (target - braking.ramp + profile.rate - 1) / profile.rate;
+    braking.peak = peakSteps * profile.rate;
+    braking.steps += peakSteps;
+  }
+}
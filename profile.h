@@ -0,0 +1,201 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "acctable.h"
+#include "parameters.h"
+
+/***
+ * Acceleration profiles for the motor interrupts.
+ *
+ * The speed of a motor is an index into the acceleration table and a step
+ * at index n takes the time for a constant acceleration from rest to have
+ * made n steps. Moving the index on by one entry every step is therefore
+ * the acceleration the table was built for. See acctable.cpp.
+ *
+ * A profile moves the index on by a fraction of an entry each step. The
+ * rate is in 256ths of an entry so 256 is the table acceleration, 512 is
+ * twice that and so on. That gives a trapezoid profile at any acceleration.
+ *
+ * For a jerk limited, S-curve, profile, the rate starts at
+ * PROFILE_RATE_MIN and grows by the jerk each step until it reaches the
+ * peak rate. It dies away in the same way as the target speed is
+ * approached so the steps in acceleration at either end are only half
+ * of the table acceleration. Because the interrupts run once per step,
+ * the acceleration is built up over a distance rather than a time. From
+ * zero, the first few slow steps would take far too long.
+ *
+ * Profiles are given in physical units with PROFILE_RATE() and
+ * PROFILE_JERK() and are worked out by the compiler.
+ */
+struct MotionProfile {
+  unsigned int rate;	// the peak change in speed index per step in 256ths
+  unsigned int jerk;	// the change in rate per step. Zero for a trapezoid
+};
+
+/***
+ * Where a motor is in its current speed change. Only the motor interrupt
+ * and code that has stopped it should change this.
+ */
+struct ProfileRamp {
+  unsigned int rate;	// the change in speed index on this step in 256ths
+  unsigned char fraction;	// the part of an index carried over to the next step
+  bool rising;	// the speed is going up
+  int gain;	// the index changes made while the rate was building up
+};
+
+// the rate at each end of a jerk limited ramp. Half the table acceleration
+#define PROFILE_RATE_MIN 128
+
+// the table acceleration in mm/s/s. Each wheel makes half of STEPS_FOR_ONE_METER
+#define TABLE_ACCELERATION_MM ((TABLE_ACCELERATION * 2000L) / STEPS_FOR_ONE_METER)
+// the rate for an acceleration in mm/s/s
+#define PROFILE_RATE(ACC) ((unsigned int)((256L * (ACC)) / TABLE_ACCELERATION_MM))
+// the jerk to build up to an acceleration in mm/s/s over a distance in mm. At least 1
+#define PROFILE_JERK(ACC, MM) ((unsigned int)(PROFILE_RATE(ACC) / ((MM) * STEPS_FOR_ONE_METER / 2000L) + \
+                                              (PROFILE_RATE(ACC) < ((MM) * STEPS_FOR_ONE_METER / 2000L))))
+// the rate is rounded down to a whole number of jerks so the ramps up and down match
+#define PROFILE_SCURVE_RATE(ACC, MM) (PROFILE_RATE_MIN + PROFILE_JERK(ACC, MM) * \
+                                      ((PROFILE_RATE(ACC) - PROFILE_RATE_MIN) / PROFILE_JERK(ACC, MM)))
+
+// one index per step as the motors have always done
+const MotionProfile PROFILE_TRAPEZOID = {256, 0};
+const MotionProfile PROFILE_SCURVE = {PROFILE_SCURVE_RATE(SCURVE_ACCELERATION, SCURVE_RAMP),
+                                      PROFILE_JERK(SCURVE_ACCELERATION, SCURVE_RAMP)
+                                     };
+
+/***
+ * Move a speed one step towards its target following the profile.
+ *
+ * Called from the motor interrupts on every step so it is kept to a few
+ * byte and word operations with no multiplication or division. The rate
+ * starts to fall once the index still to go is no more than the change
+ * made while it was building up, which makes the two ends of the ramp
+ * mirror images of each other.
+ *
+ * A change of direction, such as braking before the peak speed is
+ * reached, starts a new ramp.
+ */
+inline int profileStep(int speed, int target, const MotionProfile &profile, ProfileRamp &ramp) {
+  if (speed == target) {
+    ramp.rate = PROFILE_RATE_MIN;
+    ramp.fraction = 0;
+    ramp.gain = 0;
+    return speed;
+  }
+  bool rising = speed < target;
+  int remaining = rising ? target - speed : speed - target;
+  if (rising != ramp.rising) {
+    ramp.rising = rising;
+    ramp.rate = PROFILE_RATE_MIN;
+    ramp.gain = 0;
+  }
+  bool building = false;
+  unsigned int rate;
+  if (profile.jerk == 0) {
+    rate = profile.rate;
+  } else if (remaining <= ramp.gain) {
+    // falling in the reverse order it was built up
+    rate = ramp.rate > PROFILE_RATE_MIN ? ramp.rate : PROFILE_RATE_MIN;
+    ramp.rate = rate > PROFILE_RATE_MIN + profile.jerk ? rate - profile.jerk : PROFILE_RATE_MIN;
+  } else {
+    if (ramp.rate < profile.rate) {
+      ramp.rate += profile.jerk;
+      if (ramp.rate > profile.rate) {
+        ramp.rate = profile.rate;
+      }
+      building = true;
+    }
+    rate = ramp.rate;
+  }
+  unsigned int sum = ramp.fraction + rate;
+  ramp.fraction = sum & 0xff;
+  int change = sum >> 8;
+  if (building) {
+    ramp.gain += change;
+  }
+  if (change > remaining) {
+    change = remaining;
+  }
+  return rising ? speed + change : speed - change;
+}
+
+/***
+ * The braking steps of a motor, kept up to date as its speed changes so
+ * that the motor interrupts need not call profileSteps() on every step.
+ * The steps are counted as profileSteps() counts them: pairs of ramp
+ * steps while the rate builds up, then steps at the peak rate.
+ */
+struct ProfileBraking {
+  int change;	// the speed change the steps are for
+  long steps;	// profileSteps() for that change
+  unsigned int rate;	// the rate of the last pair of ramp steps counted
+  long ramp;	// the change made by the ramp steps in 256ths
+  long peak;	// the change made by the steps at the peak rate in 256ths
+};
+
+long profileSteps(int change, const MotionProfile &profile);
+void profileBrakingStart(ProfileBraking &braking, int change, const MotionProfile &profile);
+
+/***
+ * The braking steps after the speed change has moved on from the one in
+ * braking. Steps are counted on or off one at a time until they cover the
+ * new change, so for the few entries a speed changes by in one motor
+ * step this is a handful of additions and comparisons. Use
+ * profileBrakingStart() for a new move or profile.
+ */
+inline long profileBraking(ProfileBraking &braking, int change, const MotionProfile &profile) {
+  long target = (long)change << 8;
+  if (change > braking.change) {
+    while (profile.jerk != 0 && braking.rate < profile.rate && braking.ramp < target) {
+      braking.rate += profile.jerk;
+      braking.ramp += 2L * braking.rate;
+      braking.steps += 2;
+    }
+    if (profile.jerk == 0 || braking.rate >= profile.rate) {
+      while (braking.ramp + braking.peak < target) {
+        braking.peak += profile.rate;
+        braking.steps++;
+      }
+    }
+  } else if (change < braking.change) {
+    while (braking.peak > 0 && braking.ramp + braking.peak - profile.rate >= target) {
+      braking.peak -= profile.rate;
+      braking.steps--;
+    }
+    while (braking.peak == 0 && braking.rate > PROFILE_RATE_MIN && braking.ramp - 2L * braking.rate >= target) {
+      braking.ramp -= 2L * braking.rate;
+      braking.rate -= profile.jerk;
+      braking.steps -= 2;
+    }
+  }
+  braking.change = change;
+  return braking.steps;
+}
+
+#endif //PROFILE_H
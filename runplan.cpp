@@ -0,0 +1,297 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#include "runplan.h"
+#include "parameters.h"
+#include "planner.h"
+
+/***
+ * The distance in mm from the corner of a smooth turn to where it starts
+ * and finishes. Zero for anything else.
+ */
+static unsigned int turnOffset(unsigned char type) {
+  switch (type) {
+    case MOVE_SS90R:
+    case MOVE_SS90L:
+    case MOVE_V90R:
+    case MOVE_V90L:
+      return SMOOTH_TURN_OFFSET;
+    case MOVE_SS45R:
+    case MOVE_SS45L:
+      return SMOOTH_TURN_45_OFFSET;
+    case MOVE_SS135R:
+    case MOVE_SS135L:
+      return SMOOTH_TURN_135_OFFSET;
+  }
+  return 0;
+}
+
+static bool isSmoothTurn(unsigned char type) {
+  return turnOffset(type) > 0;
+}
+
+/***
+ * The speed at both ends of a move of the given type. Smooth turns are
+ * made at SPEEDMAX_SMOOTH_TURN and in-place turns from rest. Treating a
+ * straight the same as an in-place turn brings the mouse to rest at the
+ * start and the end of the path.
+ */
+static int turnSpeed(unsigned char type) {
+  if (isSmoothTurn(type)) {
+    return SPEEDMAX_SMOOTH_TURN;
+  }
+  return 0;
+}
+
+/***
+ * Work out the turn made for the path character at the given index.
+ * A smooth turn needs some of the straight before it so a turn at the
+ * very start of the path, where there is none, is made in place.
+ *
+ * Returns MOVE_STRAIGHT if the character is not a turn.
+ */
+static unsigned char turnType(const RunPlan &plan, int index) {
+  bool smooth = plan.runStyle != RUN_INPLACE;
+  if (smooth) {
+    smooth = false;
+    for (int i = 0; i < index; i++) {
+      if (plan.path[i] != 'B' && plan.path[i] != ' ') {
+        smooth = true;
+        break;
+      }
+    }
+  }
+  switch (plan.path[index]) {
+    case 'R':
+      return smooth ? MOVE_SS90R : MOVE_IP90R;
+    case 'L':
+      return smooth ? MOVE_SS90L : MOVE_IP90L;
+    case 'A':
+      return MOVE_IP180;
+  }
+  return MOVE_STRAIGHT;
+}
+
+/***
+ * In a diagonal run, look at the group of turns that starts at the given
+ * index. It is run on diagonals if it has at least two turns, some of
+ * them alternate and there are never three the same in a row, which would
+ * double back on a diagonal. Its moves must also fit in one section.
+ *
+ * Returns the number of turns on the diagonal route or zero if the turns
+ * are to be made one at a time.
+ */
+static unsigned char diagonalCorners(const RunPlan &plan, int index) {
+  if (plan.runStyle != RUN_DIAGONAL || !isSmoothTurn(turnType(plan, index))) {
+    return 0;
+  }
+  const char *turns = plan.path + index;
+  int count = 0;
+  bool alternates = false;
+  while (turns[count] == 'R' || turns[count] == 'L') {
+    if (count > 0 && turns[count] != turns[count - 1]) {
+      alternates = true;
+    } else if (count > 1 && turns[count] == turns[count - 2]) {
+      return 0;
+    }
+    count++;
+  }
+  if (turns[count] == 'A' || count < 2 || !alternates) {
+    return 0;
+  }
+  unsigned char corners = 2;
+  for (int i = 1; i + 2 < count; i++) {
+    if (turns[i] == turns[i + 1]) {
+      corners++;
+    }
+  }
+  if (2 * corners > RUN_MOVES_MAX) {
+    return 0;
+  }
+  return corners;
+}
+
+// the turn on to the diagonal for a group of turns
+static unsigned char diagonalEntry(const char *turns) {
+  if (turns[0] == turns[1]) {
+    return (turns[0] == 'R') ? MOVE_SS135R : MOVE_SS135L;
+  }
+  return (turns[0] == 'R') ? MOVE_SS45R : MOVE_SS45L;
+}
+
+// the first turn of whatever is at the given index
+static unsigned char followingTurn(const RunPlan &plan, int index) {
+  if (diagonalCorners(plan, index) > 0) {
+    return diagonalEntry(plan.path + index);
+  }
+  return turnType(plan, index);
+}
+
+/***
+ * Add a move to the plan. This is where consecutive straights are merged
+ * so that a run of cells becomes one straight however long it is.
+ */
+static void runPlanAdd(RunPlan &plan, unsigned char type, unsigned int length) {
+  if (type == MOVE_STRAIGHT && plan.count > 0) {
+    RunMove &last = plan.moves[plan.count - 1];
+    if (last.type == MOVE_STRAIGHT) {
+      last.length += length;
+      return;
+    }
+  }
+  RunMove &move = plan.moves[plan.count++];
+  move.type = type;
+  move.length = length;
+  move.entrySpeed = 0;
+  move.exitSpeed = 0;
+}
+
+/***
+ * Give every move in the section its speeds. Turns are made at their own
+ * speed and each straight starts at the speed of the move before it and
+ * ends at the speed of the one after it, which may be the first turn of
+ * the next section. A smooth turn starts and finishes some way from its
+ * corner, given by turnOffset(), so the straights and diagonals either
+ * side of it are shortened to suit.
+ *
+ * Straights are measured to the cell centre where the next turn is made.
+ * The corner of a 45 degree turn on to a diagonal is half a cell before
+ * that and the corner of a 135 degree turn half a cell beyond it.
+ */
+static void runPlanOptimise(RunPlan &plan) {
+  unsigned char following = followingTurn(plan, plan.index);
+  for (unsigned char i = 0; i < plan.count; i++) {
+    RunMove &move = plan.moves[i];
+    if (move.type != MOVE_STRAIGHT && move.type != MOVE_DIAGONAL) {
+      move.entrySpeed = turnSpeed(move.type);
+      move.exitSpeed = move.entrySpeed;
+      continue;
+    }
+    // a section only starts with a straight at the start of the path
+    unsigned char before = (i > 0) ? plan.moves[i - 1].type : (unsigned char)MOVE_STRAIGHT;
+    unsigned char after = (i + 1 < plan.count) ? plan.moves[i + 1].type : following;
+    move.entrySpeed = turnSpeed(before);
+    move.exitSpeed = turnSpeed(after);
+    move.length -= turnOffset(before);
+    move.length -= turnOffset(after);
+    if (move.type != MOVE_STRAIGHT) {
+      continue;
+    }
+    if (after == MOVE_SS45R || after == MOVE_SS45L) {
+      move.length -= 90;
+    } else if (after == MOVE_SS135R || after == MOVE_SS135L) {
+      move.length += 90;
+    }
+  }
+}
+
+/***
+ * Add the moves for a group of turns that is run on diagonals, with the
+ * straight that follows it.
+ *
+ * Each cell of the group is entered across a wall and the midpoints of
+ * those walls are DIAGONAL_MM(1) apart along the diagonal. The turn on
+ * to the diagonal is one wall before the first one crossed in the group
+ * and each V90 is at a wall where the turns do not alternate. The turn
+ * off the diagonal is at the last wall crossed for a 45 degree turn or
+ * half a cell beyond it for a 135. The straight that follows is measured
+ * from there to the next cell centre.
+ */
+static void runPlanDiagonal(RunPlan &plan) {
+  const char *turns = plan.path + plan.index;
+  int count = 0;
+  while (turns[count] == 'R' || turns[count] == 'L') {
+    count++;
+  }
+  runPlanAdd(plan, diagonalEntry(turns), 0);
+  int corner = -1;
+  for (int i = 1; i + 2 < count; i++) {
+    if (turns[i] == turns[i + 1]) {
+      runPlanAdd(plan, MOVE_DIAGONAL, DIAGONAL_MM(i - corner));
+      runPlanAdd(plan, (turns[i] == 'R') ? MOVE_V90R : MOVE_V90L, 0);
+      corner = i;
+    }
+  }
+  runPlanAdd(plan, MOVE_DIAGONAL, DIAGONAL_MM(count - 1 - corner));
+  char last = turns[count - 1];
+  if (turns[count - 2] == last) {
+    runPlanAdd(plan, (last == 'R') ? MOVE_SS135R : MOVE_SS135L, 0);
+    runPlanAdd(plan, MOVE_STRAIGHT, 270);
+  } else {
+    runPlanAdd(plan, (last == 'R') ? MOVE_SS45R : MOVE_SS45L, 0);
+    runPlanAdd(plan, MOVE_STRAIGHT, 90);
+  }
+  plan.index += count;
+}
+
+/***
+ * Get ready to plan a run along a path string in the format made by
+ * pathGenerate(). The mouse is assumed to start at rest in the centre
+ * of the first cell, facing along the first straight.
+ */
+void runPlanBegin(RunPlan &plan, const char *pathString, unsigned char runStyle) {
+  plan.path = pathString;
+  plan.index = 0;
+  plan.runStyle = runStyle;
+  plan.count = 0;
+}
+
+/***
+ * Plan the next section of the path into plan.moves. Each 'F' adds a
+ * cell to the current straight, each turn adds the turn and a cell
+ * after it. In a diagonal run, a group of turns may be added all at
+ * once by runPlanDiagonal(). A section ends at the end of the path or,
+ * when the moves are nearly used up, just before a turn.
+ *
+ * Returns false once there is nothing left to run.
+ */
+bool runPlanNext(RunPlan &plan) {
+  plan.count = 0;
+  while (char c = plan.path[plan.index]) {
+    if (c == 'S') {
+      break;
+    }
+    unsigned char turn = turnType(plan, plan.index);
+    if (c == 'F') {
+      runPlanAdd(plan, MOVE_STRAIGHT, 180);
+    } else if (turn != MOVE_STRAIGHT) {
+      unsigned char corners = diagonalCorners(plan, plan.index);
+      unsigned char needed = (corners > 0) ? 2 * corners : 2;
+      if (plan.count + needed > RUN_MOVES_MAX) {
+        break;
+      }
+      if (corners > 0) {
+        runPlanDiagonal(plan);
+        continue;
+      }
+      runPlanAdd(plan, turn, 0);
+      runPlanAdd(plan, MOVE_STRAIGHT, 180);
+    }
+    // anything else, such as 'B' or a space, is ignored
+    plan.index++;
+  }
+  runPlanOptimise(plan);
+  return plan.count > 0;
+}
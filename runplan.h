@@ -0,0 +1,82 @@
+/***********************************************************************
+ * Copyright (c) 2018 Peter Harrison
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without l> imitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+#ifndef RUNPLAN_H
+#define RUNPLAN_H
+
+/***
+ * A speed run is planned as a short list of moves rather than driven
+ * straight from the path string. Each move is a whole straight or a
+ * single turn with the speeds it starts and finishes at so that every
+ * straight can be run as a single profiled move, accelerating for as
+ * long as there is room and braking in time for the turn at the end.
+ *
+ * Only a few moves are held at once to save RAM. The path is planned a
+ * section at a time, each section ending just before a turn.
+ *
+ * In a diagonal run, a group of turns with no straight between them is
+ * run on diagonals through the wall midpoints. It starts and ends with a
+ * 45 or 135 degree turn and two diagonals meet in a V90, a 90 degree turn
+ * made at a wall midpoint.
+ */
+
+enum {
+  MOVE_STRAIGHT,
+  MOVE_IP90R,
+  MOVE_IP90L,
+  MOVE_IP180,
+  MOVE_SS90R,
+  MOVE_SS90L,
+  MOVE_DIAGONAL,
+  MOVE_SS45R,
+  MOVE_SS45L,
+  MOVE_SS135R,
+  MOVE_SS135L,
+  MOVE_V90R,
+  MOVE_V90L
+};
+
+struct RunMove {
+  unsigned char type;
+  unsigned int length;	// straights and diagonals only, in mm
+  int entrySpeed;	// speeds are indexes into the acceleration table
+  int exitSpeed;
+};
+
+#define RUN_MOVES_MAX 16
+
+struct RunPlan {
+  const char *path;	// the path string being planned
+  int index;		// the next character of the path
+  unsigned char runStyle;	// RUN_INPLACE, RUN_SMOOTH or RUN_DIAGONAL
+  unsigned char count;	// the moves in the current section
+  RunMove moves[RUN_MOVES_MAX];
+};
+
+void runPlanBegin(RunPlan &plan, const char *pathString, unsigned char runStyle);
+bool runPlanNext(RunPlan &plan);
+
+#endif //RUNPLAN_H
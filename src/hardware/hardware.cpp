@@ -37,7 +37,7 @@
  *
  */
 #if defined(ARDUINO_AVR_UNO)
-HardwareSerial & console = Serial;
+#error The UNO has no TIMER3 for the systick and too little RAM. See hardware.h
 #elif defined(ARDUINO_AVR_LEONARDO)
 HardwareSerial & console = Serial1;
 #else
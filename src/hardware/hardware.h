@@ -31,6 +31,16 @@
 #include "Arduino.h"
 #include "digitalwritefast.h"
 
+/***
+ * The sketch is built for the Leonardo, with its ATmega32U4.
+ *
+ * The UNO is not supported. Its ATmega328P has no TIMER3 for the systick
+ * and only 2K of RAM. The 16x16 maze needs about 2K of static RAM on its
+ * own: the walls and the row bitmaps take 480 bytes, the path 258 and
+ * the flood and planner scratch 1056. That leaves the Leonardo's 2.5K
+ * for the core and the stack but there would be nothing left on an UNO.
+ */
+
 #define USE_DEBUG
 extern HardwareSerial & console;
 extern Stream & debug;
@@ -34,20 +34,44 @@
 #include "../../sensors.h"
 #include "../../navigator.h"
 #include "../../parameters.h"
+#include "../../planner.h"
+#include "../../runplan.h"
+#include "../../explore.h"
 
 Mouse mouse;
 
-char path[256];
-char commands[256];
+// room for 'B', as many as MAZE_CELLS - 1 moves from pathRoute(), 'S' and the end
+char path[MAZE_CELLS + 2];
+cell_t pathEnd;	// the cell where the path in path[] finishes
+unsigned char pathStyle = PATH_NONE;	// how path[] was made. See pathPlan()
+unsigned char pathHeading;	// the direction to face for the first move of a planned path
+static cell_t pathStart;	// the start cell of a planned path
+static unsigned int pathGeneration;	// mazeGeneration when the path was planned
+static unsigned int pathOpened;	// mazeOpened when the path was planned
+static unsigned int pathLearned;	// mazeLearned when the path was planned
+static bool pathScurve;	// mouse.scurveRuns when the path was planned
+static bool pathKnownOnly;	// the path was planned through known passages only
 char mouseState __attribute__((section(".noinit")));
 
+// how the search decides where to go. See mouseSearchTo() and the others
+enum {
+  SEARCH_TO_TARGET,
+  SEARCH_UNTIL_PROVEN,
+  SEARCH_EXPLORE
+};
+
 
 void mouseInit() {
   sensorsInit();
   mouse.handStart = false;
+  mouse.smoothSearch = true;
+  mouse.fastKnown = true;
+  mouse.scurveRuns = false;
+  mouse.inferWalls = true;
   steeringMode = SM_NONE;
   mouse.location = 0;
   mouse.heading = NORTH;
+  mouse.diagonal = false;
   mouseState = SEARCHING;
 }
 
@@ -58,11 +82,15 @@ void mouseCheckWallSensors() {
 }
 
 
-static void stopAndAdjust() {
+/***
+ * Come to a stop at the cell centre, which is the given distance from
+ * the start of the current move, and line up with any wall ahead.
+ */
+static void stopAndAdjust(long cellCentre) {
   if (mouse.frontWall) {
     steeringMode = SM_FRONT;
   }
-  motorsStopAt(MM(180));
+  motorsStopAt(cellCentre);
   adjustFrontAngle();
   adjustFrontDistance();
 }
@@ -80,17 +108,17 @@ void mouseFollowTo(int target) {
     mouseCheckWallSensors();
     mouseUpdateMapFromSensors();
     if (mouse.location == target) {
-      stopAndAdjust();
+      stopAndAdjust(MM(180));
     } else if (!mouse.leftWall) {
-      stopAndAdjust();
+      stopAndAdjust(MM(180));
       turnIP90L();
     } else if (!mouse.frontWall) {
       motorsWaitUntil(MM(180));
     } else if (!mouse.rightWall) {
-      stopAndAdjust();
+      stopAndAdjust(MM(180));
       turnIP90R();
     } else {
-      stopAndAdjust();
+      stopAndAdjust(MM(180));
       turnIP180();
     }
   }
@@ -109,30 +137,85 @@ void mouseShowStatus() {
 }
 
 /***
- * The mouse is assumed to be centrally placed in a cell and may be
- * stationary. The current location is known and need not be any cell
- * in particular.
- *
- * The walls for the current location are assumed to be correct in
- * the map.
- *
- * On execution, the mouse will search the maze until it reaches the
- * given target.
+ * Bring the costs up to date after the map changes at the current
+ * location. When looking for a proven route, each update is a pair of
+ * full floods and, once the route is proven, only known passages are
+ * used so that the mouse explores no further.
  *
- * The maze is mapped as each cell is entered. Mapping happens even in
- * cells that have already been visited. Walls are only ever added, not
- * removed.
+ * When exploring, the costs lead instead to the cell chosen by
+ * exploreChooseTarget() until there is nothing left to explore.
  *
- * It is possible for the mapping process to make the mouse think it
- * is walled in with no route to the target.
+ * Apart from the floods done to prove the route, these only run until
+ * the mouse's own cell has its cost. See mazeFloodTo().
  *
- * Returns 0  if the search is successful
- *         -1 if the maze has no route to the target.
+ * Returns true once the route is proven.
  */
-int mouseSearchTo(int target) {
+static bool mouseSearchFlood(const CellSet &target, unsigned char style, bool proven) {
+  if (style == SEARCH_TO_TARGET) {
+    mazeFloodUpdate(mouse.location);
+    return false;
+  }
+  if (!proven && style == SEARCH_EXPLORE) {
+    cell_t next;
+    proven = !exploreChooseTarget(mouse.location, next);
+    if (!proven) {
+      mazeFloodTo(next, mouse.location);
+    }
+  } else if (!proven) {
+    // the route is the same in either direction so always flood from the goal
+    proven = mazeRouteProven(0, GOAL_REGION);
+    if (!proven && target.contains(0)) {
+      mazeFloodTo(target, mouse.location);
+    }
+  }
+  if (proven) {
+    mazeFloodTo(target, mouse.location, true);
+  }
+  return proven;
+}
+
+/***
+ * Count the cells the search would go straight ahead into without
+ * leaving mapped territory. The count starts at the given cell and
+ * stops at a turn, at an unvisited cell or at the target.
+ */
+static unsigned char knownCellsAhead(cell_t cell, unsigned char heading, const CellSet &target) {
+  unsigned char count = 0;
+  while (directionToSmallest(cell, heading) == heading) {
+    cell_t next = neighbour(cell, heading);
+    if ((walls[next] & VISITED) == 0 || target.contains(next)) {
+      break;
+    }
+    cell = next;
+    count++;
+  }
+  return count;
+}
+
+/***
+ * True if the costs say the search will turn in the cell ahead. The walls
+ * seen on the way into it can still change that.
+ */
+static bool turnExpectedAhead(const CellSet &target) {
+  cell_t next = neighbour(mouse.location, mouse.heading);
+  return !target.contains(next) && directionToSmallest(next, mouse.heading) != mouse.heading;
+}
+
+/***
+ * The body of the search. See mouseSearchTo(), mouseSearchUntilProven()
+ * and mouseSearchExplore() for the details.
+ */
+static int mouseSearch(const CellSet &target, unsigned char style) {
   mazeFlood(target);
+  bool proven = false;
+  if (style != SEARCH_TO_TARGET) {
+    proven = mouseSearchFlood(target, style, proven);
+    if (proven && !target.contains(0)) {
+      return 0;
+    }
+  }
   mouseShowStatus();
-  debug << F("  searching to: ") << target << endl;
+  debug << F("  searching to: ") << target.cells[0] << endl;
   if (cost[mouse.location] == MAX_COST) {
     return -1;
   }
@@ -145,153 +228,257 @@ int mouseSearchTo(int target) {
     newHeading = directionToSmallest(mouse.location, mouse.heading);
     mouseTurnToFace(newHeading);
   }
-  while (mouse.location != target) {
-    // here the mouse is always at the center of the cell and may be
-    // stationary or moving
+  long cellCentre = MM(180);	// the next cell centre after startForward()
+  unsigned char smoothTurns = 0;	// since the last front wall alignment
+  while (!target.contains(mouse.location)) {
+    // here the mouse is always on the centre line of the cell, at the
+    // centre or just out of a smooth turn, and may be stationary or moving
     steeringMode = SM_STRAIGHT;
-    startForward(SPEEDMAX_EXPLORE);
-    motorsWaitUntil(MM(90));
+    // slow down in good time for a smooth turn in the next cell
+    if (mouse.smoothSearch && turnExpectedAhead(target)) {
+      startForward(SPEEDMAX_SEARCH_TURN);
+    } else {
+      startForward(SPEEDMAX_EXPLORE);
+    }
+    motorsWaitUntil(cellCentre - MM(90));
     // now we are at the cell boundary
     mouse.location = neighbour(mouse.location, mouse.heading);
     mouseCheckWallSensors();
     mouseShowStatus();
     mouseUpdateMapFromSensors();
-    mazeFlood(target);
-    if (mouse.location == target) {
-      stopAndAdjust();
+    proven = mouseSearchFlood(target, style, proven);
+    if (target.contains(mouse.location) || (proven && !target.contains(0))) {
+      stopAndAdjust(cellCentre);
       break;
     }
     if (cost[mouse.location] == MAX_COST) {	// are we walled in
-      stopAndAdjust();
+      stopAndAdjust(cellCentre);
       return -1;
     }
     newHeading = directionToSmallest(mouse.location, mouse.heading);
     unsigned char hdgChange = (newHeading - mouse.heading) & 0x3;
+    // turn without stopping unless it is time to align on a front wall
+    bool smooth = mouse.smoothSearch;
+    if (smoothTurns >= SEARCH_SMOOTH_TURNS_MAX && mouse.frontWall) {
+      smooth = false;
+    }
+    // a turn that was not expected may come too soon to slow down for
+    if (smooth && !motorsCanSlowTo(cellCentre - MM(SMOOTH_TURN_OFFSET), SPEEDMAX_SMOOTH_TURN)) {
+      smooth = false;
+    }
+    unsigned char known;
     switch (hdgChange) {
       case 0:	// ahead
-        motorsWaitUntil(MM(180));
+        known = mouse.fastKnown ? knownCellsAhead(mouse.location, mouse.heading, target) : 0;
+        if (known >= 2) {
+          // run to the centre of the cell before the last known one and
+          // carry on from there at the search speed
+          motorsMoveTo(cellCentre + MM(180L * (known - 1)), SPEEDMAX_SEARCH_KNOWN, SPEEDMAX_EXPLORE);
+          for (unsigned char i = 1; i < known; i++) {
+            mouse.location = neighbour(mouse.location, mouse.heading);
+          }
+        } else {
+          motorsWaitUntil(cellCentre);
+        }
+        cellCentre = MM(180);
         break;
       case 1: // right
-        stopAndAdjust();
-        turnIP90R();
+        if (smooth) {
+          motorsMoveTo(cellCentre - MM(SMOOTH_TURN_OFFSET), SPEEDMAX_SMOOTH_TURN, SPEEDMAX_SMOOTH_TURN);
+          turnSS90R();
+          smoothTurns++;
+          cellCentre = MM(180 - SMOOTH_TURN_OFFSET);
+        } else {
+          stopAndAdjust(cellCentre);
+          turnIP90R();
+          smoothTurns = 0;
+          cellCentre = MM(180);
+        }
         break;
       case 2:	// behind
-        stopAndAdjust();
+        stopAndAdjust(cellCentre);
         turnIP180();
+        smoothTurns = 0;
+        cellCentre = MM(180);
         break;
       case 3:	// left
-        stopAndAdjust();
-        turnIP90L();
+        if (smooth) {
+          motorsMoveTo(cellCentre - MM(SMOOTH_TURN_OFFSET), SPEEDMAX_SMOOTH_TURN, SPEEDMAX_SMOOTH_TURN);
+          turnSS90L();
+          smoothTurns++;
+          cellCentre = MM(180 - SMOOTH_TURN_OFFSET);
+        } else {
+          stopAndAdjust(cellCentre);
+          turnIP90L();
+          smoothTurns = 0;
+          cellCentre = MM(180);
+        }
         break;
     }
   }
   return 0;
 }
 
+/***
+ * The mouse is assumed to be centrally placed in a cell and may be
+ * stationary. The current location is known and need not be any cell
+ * in particular.
+ *
+ * The walls for the current location are assumed to be correct in
+ * the map.
+ *
+ * On execution, the mouse will search the maze until it reaches the
+ * given target. The target may be a set of cells, such as GOAL_REGION,
+ * and the search ends in whichever of them is reached first.
+ *
+ * The maze is mapped as each cell is entered. Mapping happens even in
+ * cells that have already been visited. Walls are only ever added, not
+ * removed.
+ *
+ * With fastKnown set, a straight that runs through cells which have
+ * already been visited is driven as a single move at SPEEDMAX_SEARCH_KNOWN.
+ * The cells along it are not mapped again. The mouse brakes back to
+ * SPEEDMAX_EXPLORE at the centre of the cell before the last visited
+ * one and goes on cell by cell from there, so it is at the search speed
+ * well before it reaches a turn or an unexplored cell.
+ *
+ * The next move is decided at each cell boundary. With smoothSearch set,
+ * the mouse turns left and right with smooth turns and does not stop.
+ * It only stops to line up on a front wall when it has to turn round or
+ * after SEARCH_SMOOTH_TURNS_MAX smooth turns, when the position along the
+ * maze can no longer be trusted. Otherwise every turn is made in place
+ * after stopping at the cell centre.
+ *
+ * There is not room to brake from SPEEDMAX_EXPLORE to the smooth turn
+ * speed after the boundary of the cell where the turn is made. Where the
+ * costs say the mouse will turn in the next cell, it slows to
+ * SPEEDMAX_SEARCH_TURN on the way there. A turn that comes as a surprise
+ * is made in place if the mouse is going too fast for a smooth one.
+ *
+ * All of the moves are measured from the cell centre the mouse last
+ * started from so that the time spent deciding at the boundary does not
+ * move the places where they end.
+ *
+ * It is possible for the mapping process to make the mouse think it
+ * is walled in with no route to the target.
+ *
+ * Returns 0  if the search is successful
+ *         -1 if the maze has no route to the target.
+ */
+int mouseSearchTo(const CellSet &target) {
+  return mouseSearch(target, SEARCH_TO_TARGET);
+}
 
-//--------------------------------------------------------------------------
-// assume the maze is flooded and that a simple path string has been generated
-// then run the mouse along the path.
-// run-length encoding of straights is done on the fly.
-// turns are in-place so the mouse stops after each straight.
-//--------------------------------------------------------------------------
-void mouseRunInplaceTurns(int topSpeed) { //TODO
-  pathExpand(path);
-  debug << path << endl;
-  debug << commands << endl;
-  // "HRH": in place right
-  // "HLH": in place left
-  // "HH":  half a cell forward
-  // "HS":  end after half a cell
-  int index = 0;
-  while (commands[index] != 'S') {
-    if (buttonPressed()) {
-      break;
-    }
-    if (commands[index] == 'B') {
-      index++;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'R'
-               && commands[index + 2] == 'H') {
+/***
+ * Search as mouseSearchTo() but stop exploring as soon as the shortest
+ * route between the start and the goal region is proven. That happens when
+ * no wall the mouse has not yet seen could make the route any shorter.
+ *
+ * Searching towards the goal, the search ends at the cell where the
+ * route is proven, which need not be the goal. Searching towards the
+ * start, the mouse carries on home by the shortest route through
+ * passages it has already seen so nothing more is explored.
+ *
+ * Until the route is proven, each cell needs two full floods rather
+ * than the incremental update so the decisions take a little longer.
+ *
+ * Returns 0  if the search is successful
+ *         -1 if the maze has no route to the target.
+ */
+int mouseSearchUntilProven(const CellSet &target) {
+  return mouseSearch(target, SEARCH_UNTIL_PROVEN);
+}
 
-      forward(MM(90), topSpeed, 0);
-      turnIP90R();
-      forward(MM(90), topSpeed, topSpeed);
-      index += 3;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'L'
-               && commands[index + 2] == 'H') {
-      forward(MM(90), topSpeed, 0);
-      turnIP90L();
-      forward(MM(90), topSpeed, topSpeed);
-      index += 3;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'H') {
-      forward(MM(90), topSpeed, topSpeed);;
-      index++;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'S') {
-      forward(MM(90), topSpeed, 0);
-      index++;
-    }
-  }
-  // assume we succeed
-  mouse.location = GOAL;
-  mouseShowStatus();
+/***
+ * Search as mouseSearchUntilProven() but, at each cell, head for the
+ * unexplored cell chosen by exploreChooseTarget() rather than for the
+ * target. The trip still ends when the mouse reaches the target so the
+ * mouse explores on the way out to the goal and on the way back to the
+ * start.
+ *
+ * Returns 0  if the search is successful
+ *         -1 if the maze has no route to the target.
+ */
+int mouseSearchExplore(const CellSet &target) {
+  return mouseSearch(target, SEARCH_EXPLORE);
 }
 
-//--------------------------------------------------------------------------
-// Assume the maze is flooded and that a path string already exists.
-// Convert that to half-cell straights for easier processing
-// next, convert all HRH and HLH occurences to the corresponding smooth turns
-// then run the mouse along the path.
-// run-length encoding of straights is done on the fly.
-// turns are smooth and care is taken to deal with the path end.
-//--------------------------------------------------------------------------
-void mouseRunSmoothTurns(int topSpeed) {
-  pathExpand(path);
-  // "HRH": smooth right
-  // "HLH": smooth left
-  // "HH":  half a cell forward
-  // "HS":  end after half a cell
-  int index = 0;
-  while (commands[index] != 'S') {
-    if (buttonPressed()) {
-      break;
-    }
-    if (commands[index] == 'B') {
-      index++;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'R'
-               && commands[index + 2] == 'H') {
-      forward(MM(20), topSpeed, SPEEDMAX_SMOOTH_TURN);
-      debug << 'R';
-      turnSS90R();
-      forward(MM(20), topSpeed, topSpeed);
-      index += 3;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'L'
-               && commands[index + 2] == 'H') {
-      forward(MM(20), topSpeed, SPEEDMAX_SMOOTH_TURN);
-      debug << 'L';
-      turnSS90L();
-      forward(MM(20), topSpeed, topSpeed);
-      index += 3;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'H') {
-      debug << 'H';
-      forward(MM(90), topSpeed, topSpeed);;
-      index++;
-    } else if (commands[index] == 'H'
-               && commands[index + 1] == 'S') {
-      debug << 'H';
-      forward(MM(90), topSpeed, 0);
-      index++;
+/***
+ * Assumes the maze is flooded and that a path string has been generated.
+ *
+ * Run the mouse along the path with in-place or smooth turns, or on
+ * diagonals where it can. The path is planned a section at a time by
+ * runPlanNext() so each straight is a single move. The mouse accelerates
+ * towards topSpeed, or SPEEDMAX_DIAGONAL on a diagonal, for as long as
+ * the straight allows and brakes in time to reach the speed of the turn
+ * at the end of it. The straights follow runProfile().
+ *
+ * The moves go onto the motion queue so the next section is planned while
+ * the mouse is still making the last one.
+ */
+void mouseRunPath(unsigned char runStyle, int topSpeed) {
+  RunPlan plan;
+  debug << path << endl;
+  runPlanBegin(plan, path, runStyle);
+  bool stopped = false;
+  motionQueued = true;
+  while (!stopped && runPlanNext(plan)) {
+    for (unsigned char i = 0; i < plan.count; i++) {
+      if (buttonPressed()) {
+        stopped = true;
+        break;
+      }
+      const RunMove &move = plan.moves[i];
+      switch (move.type) {
+        case MOVE_STRAIGHT:
+          forward(MM((long)move.length), topSpeed, move.exitSpeed, runProfile());
+          break;
+        case MOVE_DIAGONAL:
+          forward(MM((long)move.length), min(topSpeed, SPEEDMAX_DIAGONAL), move.exitSpeed, runProfile());
+          break;
+        case MOVE_IP90R:
+          turnIP90R();
+          break;
+        case MOVE_IP90L:
+          turnIP90L();
+          break;
+        case MOVE_IP180:
+          turnIP180();
+          break;
+        case MOVE_SS90R:
+          debug << 'R';
+          turnSS90R();
+          break;
+        case MOVE_SS90L:
+          debug << 'L';
+          turnSS90L();
+          break;
+        case MOVE_V90R:
+          turnSS90R();
+          break;
+        case MOVE_V90L:
+          turnSS90L();
+          break;
+        case MOVE_SS45R:
+          turnSS45R();
+          break;
+        case MOVE_SS45L:
+          turnSS45L();
+          break;
+        case MOVE_SS135R:
+          turnSS135R();
+          break;
+        case MOVE_SS135L:
+          turnSS135L();
+          break;
+      }
     }
   }
+  motionQueued = false;
+  motorsWaitForMove();
   debug << 'S' << endl;
   // assume we succeed
-  mouse.location = GOAL;
+  mouse.location = pathEnd;
   mouseShowStatus();
 }
 
@@ -392,7 +579,10 @@ void mouseUpdateMapFromSensors() {
       // This is an error. We should handle it.
       break;
   }
-  walls[mouse.location] |= VISITED;
+  mazeMarkVisited(mouse.location);
+  if (mouse.inferWalls) {
+    mazeInferWalls(mouse.location);
+  }
 }
 
 
@@ -422,7 +612,7 @@ int mouseSearchMaze() {
   motorsEnable();
   mouse.location = 0;
   mouse.heading = NORTH;
-  int result = mouseSearchTo(GOAL);
+  int result = mouseSearchTo(GOAL_REGION);
   if (result != 0) {
     panic();
   }
@@ -461,10 +651,17 @@ int mouseRunMaze() {
     steeringMode = SM_STRAIGHT;
     mouse.location = 0;
     mouse.heading = NORTH;
-    mouseSearchTo(GOAL);
-    digitalWrite(GREEN_LED, 1);
-    mouseSearchTo(0);
-    digitalWrite(GREEN_LED, 0);
+    // each pass that ends unproven has explored at least one more cell
+    int result;
+    do {
+      result = mouseSearchExplore(GOAL_REGION);
+      digitalWrite(GREEN_LED, 1);
+      if (result == 0) {
+        result = mouseSearchExplore(0);
+      }
+      digitalWrite(GREEN_LED, 0);
+    } while (result == 0 && !mazeRouteProven(0, GOAL_REGION));
+    debug << F("Dead end cells: ") << mazePrunedCount << endl;
     digitalWrite(RED_LED, 1);
     mouseTurnToFace(NORTH);
     // we have a solution and the mouse is at the start ready to run
@@ -473,8 +670,7 @@ int mouseRunMaze() {
     mouseState = INPLACE_RUN;
   }
   if (mouseState == INPLACE_RUN) {
-    mazeFlood(GOAL);
-    pathGenerate(0);
+    pathPlan(0, RUN_INPLACE, true);
     debug << F("Maze is searched\nwaiting inplace for start\n");
     if (waitForStart() == 0) {
       return 0;
@@ -482,7 +678,7 @@ int mouseRunMaze() {
     digitalWrite(GREEN_LED, 0);
     digitalWrite(RED_LED, 0);
     console.println(F("Running in place"));
-    mouseRunInplaceTurns(SPEEDMAX_STRAIGHT);
+    mouseRunPath(RUN_INPLACE, SPEEDMAX_STRAIGHT);
     console.println(F("Returning"));
     mouseSearchTo(0);
     console.println(F("Done"));
@@ -490,16 +686,30 @@ int mouseRunMaze() {
   }
   if (mouseState == SMOOTH_RUN) {
     // now try with smooth turns;
-    mazeFlood(GOAL);
-    pathGenerate(0);
-    mouseTurnToFace(directionToSmallest(mouse.location, mouse.heading));
+    pathPlan(0, RUN_SMOOTH, true);
+    mouseTurnToFace(pathHeading);
     delay(200);
     debug << F("waiting for smooth run start\n");
     if (waitForStart() == 0) {
       return 0;
     }
     console.println(F("Running smooth"));
-    mouseRunSmoothTurns(SPEEDMAX_STRAIGHT);
+    mouseRunPath(RUN_SMOOTH, SPEEDMAX_STRAIGHT);
+    console.println(F("Returning"));
+    mouseSearchTo(0);
+    console.println(F("Done"));
+    mouseState = DIAGONAL_RUN;
+  }
+  if (mouseState == DIAGONAL_RUN) {
+    pathPlan(0, RUN_DIAGONAL, true);
+    mouseTurnToFace(pathHeading);
+    delay(200);
+    debug << F("waiting for diagonal run start\n");
+    if (waitForStart() == 0) {
+      return 0;
+    }
+    console.println(F("Running diagonals"));
+    mouseRunPath(RUN_DIAGONAL, SPEEDMAX_STRAIGHT);
     console.println(F("Returning"));
     mouseSearchTo(0);
     console.println(F("Finished"));
@@ -565,11 +775,12 @@ int mouseRunMaze() {
  *
  */
 
-bool pathGenerate(unsigned char startCell) {
+bool pathGenerate(cell_t startCell) {
   bool solved = true;;
-  unsigned char cell = startCell;
+  pathStyle = PATH_NONE;
+  cell_t cell = startCell;
   int nextCost = cost[cell] - 1;	// assumes manhattan flood
-  unsigned char commandIndex = 0;
+  cell_t commandIndex = 0;
   path[commandIndex++] = 'B';
   unsigned char direction = directionToSmallest(cell, NORTH);
   while (nextCost >= 0) {
@@ -679,62 +890,154 @@ bool pathGenerate(unsigned char startCell) {
   path[commandIndex] = 'S';
   commandIndex++;
   path[commandIndex] = '\0';
+  pathEnd = cell;
   return solved;
 }
 
 /***
- * Assumes that the maze is flooded and a path string has been generated.
- *
- * Convert  the simple path string to a set of commands using half-cell
- * moves instead of full-cell moves so that a sequence like
- * 		BFRFLS
- * becomes
- * 		BHHRHHHHLHHS
+ * Generate a path from one cell to the nearest of the targets without a
+ * flood. The route comes from mazeRoute() and is written to path[] in
+ * the same format as pathGenerate(), with pathEnd set to the target it
+ * reaches. As there, the mouse is assumed to face along the first move.
+ * That direction is returned in heading, which is left alone when the
+ * cell is already a target.
  *
- * The turns all have an implied full cell forward movement after them
- * The only real advantage of this is that it is easier to convert to smooth
- * turns by looking for patterns like HRH and HLH
+ * Uses costKnown[] as working space. cost[] is not changed.
  *
+ * Returns the number of cells moved, or -1, leaving path[] unchanged,
+ * if there is no route.
+ */
+int pathRoute(cell_t from, const CellSet &targets, bool knownOnly, unsigned char &heading) {
+  // the directions go where the moves will be and are replaced in turn
+  unsigned char *directions = (unsigned char *)path + 1;
+  pathStyle = PATH_NONE;
+  int length = mazeRoute(from, targets, knownOnly, directions);
+  if (length < 0) {
+    return -1;
+  }
+  if (length > 0) {
+    heading = directions[0];
+  }
+  cell_t cell = from;
+  unsigned char previous = directions[0];
+  path[0] = 'B';
+  for (int i = 0; i < length; i++) {
+    unsigned char direction = directions[i];
+    char cmd = 'F';
+    if (direction == DtoR[previous]) {
+      cmd = 'R';
+    } else if (direction == DtoL[previous]) {
+      cmd = 'L';
+    } else if (direction == DtoB[previous]) {
+      cmd = 'A';
+    }
+    path[i + 1] = cmd;
+    cell = neighbour(cell, direction);
+    previous = direction;
+  }
+  path[length + 1] = 'S';
+  path[length + 2] = '\0';
+  pathEnd = cell;
+  return length;
+}
+
 
+
+/***
+ * True if the moves in path[] can still be driven from the cell without
+ * running into a wall, starting with the mouse facing along heading.
  */
-void pathExpand(char * pathString) {
-  int pathIndex = 0;
-  int commandIndex = 0;
-  commands[commandIndex++] = 'B';
-  while (char c = pathString[pathIndex]) {
-    switch (c) {
-      case 'F':
-        commands[commandIndex++] = 'H';
-        commands[commandIndex++] = 'H';
-        pathIndex++;
-        break;
+static bool pathIsOpen(cell_t cell, unsigned char heading) {
+  for (int i = 0; path[i]; i++) {
+    switch (path[i]) {
       case 'R':
-        commands[commandIndex++] = 'R';
-        commands[commandIndex++] = 'H';
-        commands[commandIndex++] = 'H';
-        pathIndex++;
+        heading = DtoR[heading];
         break;
       case 'L':
-        commands[commandIndex++] = 'L';
-        commands[commandIndex++] = 'H';
-        commands[commandIndex++] = 'H';
-        pathIndex++;
+        heading = DtoL[heading];
         break;
-      case 'S':
-        commands[commandIndex++] = 'S';
-        pathIndex++;
+      case 'A':
+        heading = DtoB[heading];
         break;
-      case 'B':
-      case ' ':	// ignore these so we can write easy-to-read path strings
-        pathIndex++;
+      case 'F':
         break;
       default:
-        // TODO: this is an error. We should handle it.
-        break;
+        continue;
+    }
+    if (!hasExit(cell, heading)) {
+      return false;
     }
+    cell = neighbour(cell, heading);
   }
-  commands[commandIndex] = '\0';
+  return true;
 }
 
-
-
+/***
+ * Plan a path from the start cell to the goal region into path[] and
+ * set pathHeading to the direction the mouse must face to start it.
+ *
+ * The style is one of the planner run styles, RUN_INPLACE, RUN_SMOOTH or
+ * RUN_DIAGONAL, for the quickest path from plannerFlood(), or
+ * PATH_SHORTEST for the fewest cells from mazeFlood().
+ *
+ * With knownOnly set, the path only uses passages the mouse has seen, as
+ * a speed run must. The shortest path then comes from pathRoute() and
+ * the quickest from a known-only plannerFlood().
+ *
+ * A solved path is remembered along with the wall generation it was
+ * planned in. If the same path is asked for again, the one already in
+ * path[] is used unless the map has changed in a way that matters:
+ *
+ *  - a wall was removed. That could open a better route anywhere.
+ *  - a wall was added across the path. It can no longer be driven.
+ *  - mouse.scurveRuns was changed. The planner times are different.
+ *  - knownOnly was changed. The path may use the wrong passages.
+ *  - for a known-only path, a wall became known. A passage seen to be
+ *    open could make a shorter known route.
+ *
+ * Otherwise, a wall added anywhere else can only make other routes
+ * worse, so the path is still the best one. Anything else that writes to path[]
+ * clears pathStyle so that it is not mistaken for a planned path.
+ *
+ * Only path[] and pathHeading are kept. When the path is reused, the
+ * costs from the floods may belong to some other plan.
+ *
+ * Returns true if every cell on the path has been visited or, for the
+ * shortest known path, if there is one.
+ */
+bool pathPlan(cell_t startCell, unsigned char style, bool knownOnly) {
+  if (style == pathStyle && startCell == pathStart && mouse.scurveRuns == pathScurve && knownOnly == pathKnownOnly &&
+      (!knownOnly || mazeLearned == pathLearned)) {
+    if (mazeGeneration == pathGeneration) {
+      return true;
+    }
+    if (mazeOpened == pathOpened && pathIsOpen(startCell, pathHeading)) {
+      pathGeneration = mazeGeneration;
+      return true;
+    }
+  }
+  bool solved;
+  unsigned char heading = NORTH;
+  if (style == PATH_SHORTEST && knownOnly) {
+    solved = pathRoute(startCell, GOAL_REGION, true, heading) >= 0;
+  } else if (style == PATH_SHORTEST) {
+    mazeFlood(GOAL_REGION);
+    solved = pathGenerate(startCell);
+    heading = directionToSmallest(startCell, NORTH);
+  } else {
+    plannerFlood(GOAL_REGION, style, knownOnly);
+    solved = plannerPathGenerate(startCell);
+    heading = plannerDirection(startCell, NORTH);
+  }
+  pathHeading = heading;
+  if (solved) {
+    pathStyle = style;
+    pathStart = startCell;
+    pathGeneration = mazeGeneration;
+    pathOpened = mazeOpened;
+    pathLearned = mazeLearned;
+    pathScurve = mouse.scurveRuns;
+    pathKnownOnly = knownOnly;
+  }
+  return solved;
+}
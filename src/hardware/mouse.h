@@ -28,45 +28,67 @@
 #ifndef MOUSE_H
 #define MOUSE_H
 
+#include "../../maze.h"
+#include "../../profile.h"
+
 
 enum {
   FRESH_START,
   SEARCHING,
   INPLACE_RUN,
   SMOOTH_RUN,
+  DIAGONAL_RUN,
   FINISHED
 };
 
 class Mouse {
 public:
   unsigned char heading;
-  unsigned char location;
+  bool diagonal;	// heading is 45 degrees anticlockwise of the actual direction
+  cell_t location;
   bool leftWall;
   bool frontWall;
   bool rightWall;
   bool handStart;
+  bool smoothSearch;	// search with smooth turns instead of stopping
+  bool inferWalls;	// add the walls that follow from the contest rules while mapping
+  bool fastKnown;	// search straights through visited cells at SPEEDMAX_SEARCH_KNOWN
+  bool scurveRuns;	// speed run straights use PROFILE_SCURVE rather than PROFILE_TRAPEZOID
 };
 
 extern char mouseState;
 
 extern Mouse mouse;
+
+// the acceleration profile for the straights of a speed run
+inline const MotionProfile &runProfile() {
+  return mouse.scurveRuns ? PROFILE_SCURVE : PROFILE_TRAPEZOID;
+}
+// pathPlan() styles as well as the planner's RUN_INPLACE, RUN_SMOOTH and RUN_DIAGONAL
+#define PATH_SHORTEST 3	// the fewest cells, from mazeFlood()
+#define PATH_NONE 0xff	// path[] was not made by pathPlan()
+
 extern  char path[];
-extern  char commands[];
+extern cell_t pathEnd;
+extern unsigned char pathStyle;
+extern unsigned char pathHeading;
 
 void mouseInit();
 void mouseCheckWallSensors();
 void mouseTurnToFace(unsigned char newHeading);
 void mouseFollowTo(int target);
-int mouseSearchTo(int target);
-void mouseRunInplaceTurns(int topSpeed);
-void mouseRunSmoothTurns(int topSpeed);
+int mouseSearchTo(const CellSet &target);
+int mouseSearchUntilProven(const CellSet &target);
+int mouseSearchExplore(const CellSet &target);
+void mouseRunPath(unsigned char runStyle, int topSpeed);
 void mouseUpdateMapFromSensors();
 
 int mouseSearchMaze();
 int mouseRunMaze();
 
-bool pathGenerate(unsigned char startCell);
-void pathExpand(char * pathString);
+bool pathGenerate(cell_t startCell);
+int pathRoute(cell_t from, const CellSet &targets, bool knownOnly, unsigned char &heading);
+bool pathPlan(cell_t startCell, unsigned char style, bool knownOnly = false);
 
 
 #endif //MOUSE_H
@@ -26,27 +26,61 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+#include <stdint.h>
+
+/***
+ * A fixed size ring buffer used as a FIFO work queue by the floods and
+ * to hold the segments for the motor interrupts.
+ *
+ * The storage is part of the queue object so a queue declared in a function
+ * lives on the stack and the heap is never used. The capacity is fixed at
+ * compile time and is rounded up to a power of two so that the indices can
+ * wrap with a mask instead of a compare and subtract. When the capacity is
+ * 256 or less, the indices are single bytes.
+ *
+ * There is no overflow check in normal builds. Callers that cannot be sure
+ * of the queue size should test full() before adding. Define QUEUE_DEBUG as
+ * 1 to have every queue type count overflows and removals and keep a
+ * high-water mark.
+ */
+#ifndef QUEUE_DEBUG
+#define QUEUE_DEBUG 0
+#endif
+
+// the smallest power of two that is at least n
+constexpr int queueCapacity(int n, int p = 1) {
+  return (p >= n) ? p : queueCapacity(n, 2 * p);
+}
+
+template<bool small>
+struct QueueIndex {
+  typedef uint16_t type;
+};
+
+template<>
+struct QueueIndex<true> {
+  typedef uint8_t type;
+};
 
-template<class item_t>
+template<class item_t, int SIZE = 64>
 class Queue {
 public:
+  static const int CAPACITY = queueCapacity(SIZE);
+  static const int MASK = CAPACITY - 1;
+  typedef typename QueueIndex<(CAPACITY <= 256)>::type index_t;
 
-  explicit Queue(int maxSize = 64) :
-    MAX_ITEMS(maxSize) {
-    mData = new item_t[MAX_ITEMS + 1];
+  Queue() {
     clear();
   }
 
-
-
-  ~Queue() {
-    delete[] mData;
-  };
-
   int size() {
     return mItemCount;
   }
 
+  bool full() {
+    return mItemCount >= CAPACITY;
+  }
+
   void clear() {
     mHead = 0;
     mTail = 0;
@@ -57,12 +91,19 @@ public:
    * Adds an item to the tail of the queue
    */
   void add(item_t item) {
+#if QUEUE_DEBUG
+    if (full()) {
+      ++overflows;
+    }
+#endif
     mData[mTail] = item;
-    ++mTail;
+    mTail = (mTail + 1) & MASK;
     ++mItemCount;
-    if (mTail > MAX_ITEMS) {
-      mTail -= MAX_ITEMS;
+#if QUEUE_DEBUG
+    if (mItemCount > highWater) {
+      highWater = mItemCount;
     }
+#endif
   }
 
   /*
@@ -71,26 +112,42 @@ public:
    */
   item_t head() {
     item_t result = mData[mHead];
-    ++mHead;
-    if (mHead > MAX_ITEMS) {
-      mHead -= MAX_ITEMS;
-    }
+    mHead = (mHead + 1) & MASK;
     --mItemCount;
+#if QUEUE_DEBUG
+    ++removed;
+#endif
     return result;
   }
 
+#if QUEUE_DEBUG
+  // shared by every queue of the same type
+  static int highWater;
+  static int overflows;
+  static unsigned long removed;
+#endif
 
 protected:
-  item_t *mData;
-  const int MAX_ITEMS;
-  int mHead;
-  int mTail;
+  item_t mData[CAPACITY];
+  index_t mHead;
+  index_t mTail;
   int mItemCount;
 
 private:
   // while this is probably correct, prevent use of the copy constructor
-  Queue(const Queue<item_t> &rhs) {}
+  Queue(const Queue<item_t, SIZE> &rhs) {}
 
 };
 
+#if QUEUE_DEBUG
+template<class item_t, int SIZE>
+int Queue<item_t, SIZE>::highWater = 0;
+
+template<class item_t, int SIZE>
+int Queue<item_t, SIZE>::overflows = 0;
+
+template<class item_t, int SIZE>
+unsigned long Queue<item_t, SIZE>::removed = 0;
+#endif
+
 #endif // QUEUE_H
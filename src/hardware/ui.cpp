@@ -33,6 +33,9 @@
 #include "../../sensors.h"
 #include "../../test.h"
 #include "../../parameters.h"
+#include "../../planner.h"
+#include "../../runplan.h"
+#include "../../mazefile.h"
 
 // taken from the CATERINA bootloader - run it at least 10kHz
 static volatile unsigned int LLEDPulse;
@@ -253,7 +256,7 @@ void doButton() {
     mouseRunMaze();
   } else {
     console.print(F("\nSearching...\n"));
-    testSearcher(GOAL);
+    testSearcher(GOAL_REGION);
   }
   delay(200);
   console.write(':');
@@ -267,12 +270,24 @@ void doCLI() {
   switch (data) {
     case 'g':
       console << F("Searching...") << endl;
-      testSearcher(GOAL);
+      testSearcher(GOAL_REGION);
       break;
     case 'G':
       console << F("Running...") << endl;
       mouseRunMaze();
       break;
+    case 'a':
+      console << F("Trapezoid straight...") << endl;
+      testProfile(PROFILE_TRAPEZOID);
+      break;
+    case 'A':
+      console << F("S-curve straight...") << endl;
+      testProfile(PROFILE_SCURVE);
+      break;
+    case 'y':
+    case 'Y':
+      testStepGenerators();
+      break;
     case 'c':
       console << F("Calibrate Sensors...") << endl;
       testCalibrateSensors();
@@ -288,21 +303,64 @@ void doCLI() {
     case 'm':
       printMazePlain();
       break;
+    case 'l':
+      loadMaze(MAZE_FILE_TEXT);
+      break;
+    case 'L':
+      loadMaze(MAZE_FILE_BINARY);
+      break;
+    case 'e':
+      mazeFileWrite(console, MAZE_FILE_TEXT);
+      break;
+    case 'E':
+      mazeFileWrite(console, MAZE_FILE_BINARY);
+      break;
     case 'M':
-      mazeFlood(GOAL);
+      mazeFlood(GOAL_REGION);
       printMazeDirs();
       printMazeCosts();
       break;
+#if MAZE_WIDTH == 16 && MAZE_HEIGHT == 16
+    case 'f':
+      console << F("Incremental flood - empty maze") << endl;
+      testFloodUpdate(emptyMaze);
+      console << F("Incremental flood - Japan 2007") << endl;
+      testFloodUpdate(japan2007);
+      break;
+    case 'b':
+      console << F("Bitboard flood - empty maze") << endl;
+      testFloodBits(emptyMaze);
+      console << F("Bitboard flood - Japan 2007") << endl;
+      testFloodBits(japan2007);
+      break;
+    case 'd':
+      console << F("Dual flood - empty maze") << endl;
+      testFloodDual(emptyMaze);
+      console << F("Dual flood - Japan 2007") << endl;
+      testFloodDual(japan2007);
+      break;
+    case 'o':
+      console << F("Route search - empty maze") << endl;
+      testRoute(emptyMaze);
+      console << F("Route search - Japan 2007") << endl;
+      testRoute(japan2007);
+      break;
+#endif
     case 'r':
     case 'R':
-      mazeFlood(GOAL);
-      if (pathGenerate(0)) {
+      if (pathPlan(0, PATH_SHORTEST)) {
         console.println(F("\nSolution found"));
       }
+      mazeFlood(GOAL_REGION);	// the path may be reused without a flood
       printMazeDirs();
       console.println((char*)(path));
-      pathExpand(path);
-      console.println((char*)(commands));
+      printRunPlan(RUN_SMOOTH);
+      break;
+    case 't':
+    case 'T':
+      printPathTimes(RUN_INPLACE);
+      printPathTimes(RUN_SMOOTH);
+      printPathTimes(RUN_DIAGONAL);
       break;
     case 's':
       printSensors();
@@ -316,16 +374,38 @@ void doCLI() {
       break;
     case 'x':
       console << F("Reset the maze to default empty state") << endl;
-      mazeInit(emptyMaze);
+      mazeInit(NULL);
       printMazePlain();
       mouseState = SEARCHING;
       break;
+#if MAZE_WIDTH == 16 && MAZE_HEIGHT == 16
     case 'X':
       console << F("Reset the maze to Japan 2007 Finals") << endl;
       mazeInit(japan2007);
       printMazePlain();
       mouseState = SEARCHING;
       break;
+#endif
+    case 'u':
+    case 'U':
+      mouse.smoothSearch = !mouse.smoothSearch;
+      console << F("Search turns: ") << (mouse.smoothSearch ? F("smooth") : F("in place")) << endl;
+      break;
+    case 'n':
+    case 'N':
+      mouse.inferWalls = !mouse.inferWalls;
+      console << F("Wall inference: ") << (mouse.inferWalls ? F("on") : F("off")) << endl;
+      break;
+    case 'k':
+    case 'K':
+      mouse.fastKnown = !mouse.fastKnown;
+      console << F("Known straights: ") << (mouse.fastKnown ? F("fast") : F("search speed")) << endl;
+      break;
+    case 'j':
+    case 'J':
+      mouse.scurveRuns = !mouse.scurveRuns;
+      console << F("Speed run straights: ") << (mouse.scurveRuns ? F("S-curve") : F("trapezoid")) << endl;
+      break;
     case 'i':
     case 'I':
       console << F("Mouse location: 0x") << _HEX(mouse.location) << endl;
@@ -434,8 +514,8 @@ void printHex(unsigned char value) {
  */
 
 void printNorthWalls(int row) {
-  for (int col = 0; col < 16;  col++) {
-    unsigned char cell = row + 16 * col;
+  for (int col = 0; col < MAZE_WIDTH;  col++) {
+    cell_t cell = row + MAZE_HEIGHT * col;
     console << 'o';
     if (hasWall(cell, NORTH)) {
       console << F("---");
@@ -447,8 +527,8 @@ void printNorthWalls(int row) {
 }
 
 void printSouthWalls(int row) {
-  for (int col = 0; col < 16;  col++) {
-    unsigned char cell = row + 16 * col;
+  for (int col = 0; col < MAZE_WIDTH;  col++) {
+    cell_t cell = row + MAZE_HEIGHT * col;
     console << 'o';
     if (hasWall(cell, SOUTH)) {
       console << F("---");
@@ -461,28 +541,42 @@ void printSouthWalls(int row) {
 
 void printMazePlain() {
   console.println();
-  for (int row = 15; row >= 0; row--) {
-    printNorthWalls(row);
-    for (int col = 0; col < 16; col++) {
-      unsigned char cell = static_cast<unsigned char>(row + 16 * col);
-      if (hasExit(cell, WEST)) {
-        console << F("    ");
-      } else {
-        console << F("|   ");
-      }
+  mazeFileWrite(console, MAZE_FILE_TEXT);
+  console << endl;
+}
+
+/***
+ * Load a maze file sent over the console. The file must be sent after the
+ * prompt and is read in small chunks as it arrives. If the console is quiet
+ * for longer than the stream timeout before the maze is complete, the load
+ * is abandoned and the maze is reset.
+ */
+void loadMaze(unsigned char format) {
+  char chunk[16];
+  console << F("Send the maze file now") << endl;
+  mazeFileBegin(format);
+  while (!mazeFileComplete()) {
+    int count = console.readBytes(chunk, sizeof(chunk));
+    if (count == 0) {
+      break;
     }
-    console << '|' << endl;
+    mazeFileRead(chunk, count);
   }
-  printSouthWalls(0);
-  console << endl;
+  if (!mazeFileComplete()) {
+    console << F("Maze file incomplete - maze reset") << endl;
+    mazeInit(NULL);
+    return;
+  }
+  printMazePlain();
+  mouseState = SEARCHING;
 }
 
 void printMazeCosts() {
   console << endl;
-  for (int row = 15; row >= 0; row--) {
+  for (int row = MAZE_HEIGHT - 1; row >= 0; row--) {
     printNorthWalls(row);
-    for (int col = 0; col < 16; col++) {
-      unsigned char cell = static_cast<unsigned char>(row + 16 * col);
+    for (int col = 0; col < MAZE_WIDTH; col++) {
+      cell_t cell = static_cast<cell_t>(row + MAZE_HEIGHT * col);
       if (hasExit(cell, WEST)) {
         console << ' ';
       } else {
@@ -501,10 +595,10 @@ char dirLetters[] = "NESW";
 
 void printMazeDirs() {
   console << endl;
-  for (int row = 15; row >= 0; row--) {
+  for (int row = MAZE_HEIGHT - 1; row >= 0; row--) {
     printNorthWalls(row);
-    for (int col = 0; col < 16; col++) {
-      unsigned char cell = row + 16 * col;
+    for (int col = 0; col < MAZE_WIDTH; col++) {
+      cell_t cell = row + MAZE_HEIGHT * col;
       
       if (hasWall(cell, WEST)) {
         console << '|';
@@ -512,7 +606,7 @@ void printMazeDirs() {
         console << ' ';
       }
       unsigned char direction = directionToSmallest(cell, NORTH);
-      if (cell == GOAL) {
+      if (cost[cell] == 0) {	// a flood target
         direction = 4;
       }
       console << ' ' << dirChars[direction];
@@ -524,11 +618,88 @@ void printMazeDirs() {
   console << endl;
 }
 
+/***
+ * Show the path found by the simple cell counting flood and the one found
+ * by the timed planner, each with its estimated running time.
+ */
+void printPathTimes(unsigned char runStyle) {
+  if (runStyle == RUN_DIAGONAL) {
+    console << F("Diagonals") << endl;
+  } else if (runStyle == RUN_SMOOTH) {
+    console << F("Smooth turns") << endl;
+  } else {
+    console << F("In-place turns") << endl;
+  }
+  mazeFlood(GOAL_REGION);
+  pathGenerate(0);
+  console << F("  Shortest: ") << plannerPathTime(path, runStyle) << F("ms ") << path << endl;
+  plannerFlood(GOAL_REGION, runStyle);
+  plannerPathGenerate(0);
+  console << F("  Quickest: ") << plannerPathTime(path, runStyle) << F("ms ") << path << endl;
+}
+
+/***
+ * List the moves a speed run along the current path would make, with
+ * the speeds at each end of every straight.
+ */
+void printRunPlan(unsigned char runStyle) {
+  RunPlan plan;
+  runPlanBegin(plan, path, runStyle);
+  while (runPlanNext(plan)) {
+    for (unsigned char i = 0; i < plan.count; i++) {
+      const RunMove &move = plan.moves[i];
+      switch (move.type) {
+        case MOVE_STRAIGHT:
+          console << F("  Straight ") << move.length << F("mm ");
+          console << move.entrySpeed << F(" -> ") << move.exitSpeed << endl;
+          break;
+        case MOVE_DIAGONAL:
+          console << F("  Diagonal ") << move.length << F("mm ");
+          console << move.entrySpeed << F(" -> ") << move.exitSpeed << endl;
+          break;
+        case MOVE_IP90R:
+          console << F("  Right in place") << endl;
+          break;
+        case MOVE_IP90L:
+          console << F("  Left in place") << endl;
+          break;
+        case MOVE_IP180:
+          console << F("  About turn") << endl;
+          break;
+        case MOVE_SS90R:
+          console << F("  Smooth right") << endl;
+          break;
+        case MOVE_SS90L:
+          console << F("  Smooth left") << endl;
+          break;
+        case MOVE_SS45R:
+          console << F("  Right 45") << endl;
+          break;
+        case MOVE_SS45L:
+          console << F("  Left 45") << endl;
+          break;
+        case MOVE_SS135R:
+          console << F("  Right 135") << endl;
+          break;
+        case MOVE_SS135L:
+          console << F("  Left 135") << endl;
+          break;
+        case MOVE_V90R:
+          console << F("  Right V90") << endl;
+          break;
+        case MOVE_V90L:
+          console << F("  Left V90") << endl;
+          break;
+      }
+    }
+  }
+}
+
 void printMazeWallData() {
   console << endl;
-  for (int row = 15; row >= 0; row--) {
-    for (int col = 0; col < 16; col++) {
-      int cell = row + 16 * col;
+  for (int row = MAZE_HEIGHT - 1; row >= 0; row--) {
+    for (int col = 0; col < MAZE_WIDTH; col++) {
+      int cell = row + MAZE_HEIGHT * col;
       printHex(walls[cell]);
       console << ' ';
     }
@@ -546,13 +717,26 @@ void printHelp() {
   console << F("\tC   - Start Front Sensors Calibration") << endl;
   console << F("\tw,W - Print Maze Walls") << endl;
   console << F("\tm   - Print Maze Walls Simple") << endl;
+  console << F("\tl,L - Load Maze File as Text or Binary") << endl;
+  console << F("\te,E - Send Maze File as Text or Binary") << endl;
   console << F("\tM   - Print Maze Directions and Costs") << endl;
+  console << F("\tf   - Test Incremental Flood") << endl;
+  console << F("\tb   - Test Bitboard Flood") << endl;
+  console << F("\td   - Test Dual Flood") << endl;
+  console << F("\to   - Test Route Search") << endl;
   console << F("\tr,R - Test Solution") << endl;
+  console << F("\tt,T - Compare Shortest and Quickest Paths") << endl;
   console << F("\ts   - Print Sensors") << endl;
   console << F("\tS   - Print Current Walls") << endl;
   console << F("\tp,P - Print Mouse Parameters") << endl;
   console << F("\tx   - Reset Maze") << endl;
   console << F("\tX   - Reset Maze to Japan 2007 Finals") << endl;
+  console << F("\tu,U - Toggle Smooth or In Place Search Turns") << endl;
+  console << F("\tn,N - Toggle Wall Inference") << endl;
+  console << F("\tk,K - Toggle Fast Straights Through Known Cells") << endl;
+  console << F("\tj,J - Toggle S-Curve Speed Run Straights") << endl;
+  console << F("\ta,A - Time a Trapezoid or S-Curve Straight") << endl;
+  console << F("\ty,Y - Count Step Generator Cycles") << endl;
   console << F("\ti,I - Print Mouse Location/Direction") << endl;
   console << F("\th,H - Print Help Page") << endl;
 }
@@ -60,9 +60,12 @@ void printCurrentWalls();
 void printMouseParameters();
 
 void printMazePlain();
+void loadMaze(unsigned char format);
 void printMazeCosts();
 void printMazeDirs();
 void printMazeWallData();
+void printPathTimes(unsigned char runStyle);
+void printRunPlan(unsigned char runStyle);
 
 void printHelp();
 
@@ -37,6 +37,8 @@
 #include "src/hardware/ui.h"
 #include "src/hardware/volatiles.h"
 #include "src/hardware/streaming.h"
+#include "src/hardware/queue.h"
+#include "avr/pgmspace.h"
 
 // Print colors
 #define ANSI_COLOR_RED     "\x1b[31m"
@@ -44,6 +46,8 @@
 #define ANSI_COLOR_MAGENTA  "\u001b[35m"
 #define ANSI_COLOR_RESET   "\x1b[0m"
 
+extern char *__brkval;	// the top of the heap, maintained by malloc()
+
 // taken from Repetier 3D printer sources
 int getFreeRam() {
   int freeram = 0;
@@ -139,6 +143,72 @@ void testForward(long distance, int maxSpeed) {
   motorsDisable();
 }
 
+/***
+ * Time a four cell straight from rest to rest with the given profile.
+ * Run it with each profile at a few accelerations and look for the
+ * quickest time that still finishes in the right place. A missed step
+ * shows up as the mouse stopping short.
+ */
+void testProfile(const MotionProfile &profile) {
+  if (waitForStart() == 0) {
+    return ;
+  }
+  motorsEnable();
+  digitalWrite(GREEN_LED, 1);
+  steeringMode = SM_NONE;
+  unsigned long start = micros();
+  forward(MM(4 * 180), SPEEDMAX_STRAIGHT, 0, profile);
+  unsigned long time = micros() - start;
+  digitalWrite(GREEN_LED, 0);
+  motorsDisable();
+  console << F("Rate: ") << profile.rate << F("  Jerk: ") << profile.jerk;
+  console << F("  Time: ") << time / 1000 << F("ms") << endl;
+}
+
+/***
+ * Cycles for one call of a motor update function with the speed and target
+ * given. The interrupts are off so Timer 1 counts only the calls, eight
+ * processor cycles to a count.
+ */
+static unsigned int testUpdateCycles(void (*update)(), int speed, int target) {
+  const int calls = 64;
+  motorsHalt();
+  setVolatile(speedLeft, speed);
+  speedTargetLeft = target;
+  noInterrupts();
+  update();
+  uint16_t start = TCNT1;
+  for (int i = 0; i < calls; i++) {
+    update();
+  }
+  uint16_t counts = TCNT1 - start;
+  interrupts();
+  motorsHalt();
+  return (counts * (F_CPU / F_COUNTER)) / calls;
+}
+
+/***
+ * Compare the two step generators with the motors off. Each update is
+ * called directly for the left wheel, cruising and accelerating at
+ * SPEEDMAX_STRAIGHT. The table update runs once per step and the DDA once
+ * per tick, so the load on the processor from both wheels at that speed is
+ * given as well. Entering and leaving the interrupt adds about 50 cycles
+ * to each call. MOTORS_DDA picks the one the interrupts use.
+ */
+void testStepGenerators() {
+  motorsDisable();
+  unsigned int tableCruise = testUpdateCycles(motorLeftupdate, SPEEDMAX_STRAIGHT, SPEEDMAX_STRAIGHT);
+  unsigned int tableRamp = testUpdateCycles(motorLeftupdate, SPEEDMAX_STRAIGHT / 2, SPEEDMAX_STRAIGHT);
+  unsigned int ddaCruise = testUpdateCycles(motorLeftDda, SPEEDMAX_STRAIGHT, SPEEDMAX_STRAIGHT);
+  unsigned int ddaRamp = testUpdateCycles(motorLeftDda, SPEEDMAX_STRAIGHT / 2, SPEEDMAX_STRAIGHT);
+  long stepRate = F_MOTOR_TIMER / accTable(SPEEDMAX_STRAIGHT);
+  console << F("Step generator: ") << (MOTORS_DDA ? F("DDA") : F("table")) << endl;
+  console << F("  Table: ") << tableCruise << F(" cycles cruising  ") << tableRamp << F(" accelerating  ");
+  console << (200L * tableCruise * stepRate) / F_CPU << F("% at ") << stepRate << F(" steps/s") << endl;
+  console << F("  DDA:   ") << ddaCruise << F(" cycles cruising  ") << ddaRamp << F(" accelerating  ");
+  console << (200L * ddaCruise * DDA_TICK_HZ) / F_CPU << F("% at ") << (long)DDA_TICK_HZ << F(" ticks/s") << endl;
+}
+
 void testSteering() {
   int choice = waitForStart();
   if (choice == LEFT) {
@@ -166,7 +236,7 @@ void testFollower(int target) {
   motorsDisable();
 }
 
-void testSearcher(int target) {
+void testSearcher(const CellSet &target) {
   if (waitForStart() == 0) {
     return ;
   }
@@ -302,4 +372,205 @@ void testCalibrateSensors() {
     }
     tmpInput = console.read();
   }
-}
\ No newline at end of file
+}
+
+
+/***
+ * Walk a simulated mouse from its current cell to the target, learning the
+ * walls of the given sample maze one cell at a time. After each cell, the
+ * incremental flood is checked against a full flood in every cell and the
+ * time taken by each is accumulated.
+ *
+ * The full flood goes into costKnown[] by way of mazeFloodSecond() so that
+ * the two cost maps can be compared without a copy of either on the stack.
+ * Any cell the update got wrong is put right before the next step.
+ */
+struct FloodTrace {
+  cell_t location;
+  unsigned char heading;
+  int steps;
+  int errors;
+  unsigned long updateTime;
+  unsigned long floodTime;
+};
+
+static void testFloodTrip(const unsigned char *testMaze, const CellSet &target, FloodTrace &trace) {
+  mazeFlood(target);
+  while (!target.contains(trace.location)) {
+    trace.location = neighbour(trace.location, trace.heading);
+    unsigned char realWalls = pgm_read_byte(testMaze + trace.location);
+    for (unsigned char direction = 0; direction < 4; direction++) {
+      if ((realWalls & (1 << direction)) && hasExit(trace.location, direction)) {
+        mazeSetWall(trace.location, direction);
+      }
+    }
+    mazeMarkVisited(trace.location);
+    unsigned long start = micros();
+    mazeFloodUpdate(trace.location);
+    unsigned long middle = micros();
+    mazeFloodSecond(target);
+    unsigned long end = micros();
+    trace.updateTime += middle - start;
+    trace.floodTime += end - middle;
+    trace.steps++;
+    for (int i = 0; i < MAZE_CELLS; i++) {
+      if (cost[i] != costKnown[i]) {
+        cost[i] = costKnown[i];
+        trace.errors++;
+      }
+    }
+    if (cost[trace.location] == MAX_COST) {
+      break;
+    }
+    trace.heading = directionToSmallest(trace.location, trace.heading);
+  }
+}
+
+/***
+ * Check mazeFloodUpdate() against mazeFlood() over a simulated search of a
+ * sample maze, out to the goal and back to the start. The mouse does not move.
+ *
+ * Reports the number of cell costs that differ (there should be none) and
+ * the average time and cycle count for each method per step. Times include
+ * the systick interrupt.
+ *
+ * The floods should never use the heap so the top of the heap is checked
+ * before and after. With QUEUE_DEBUG set, the queue high-water mark and
+ * any overflows are reported as well.
+ *
+ * On exit, the map holds the walls found by the simulated search.
+ */
+void testFloodUpdate(const unsigned char *testMaze) {
+  FloodTrace trace = {0, NORTH, 0, 0, 0, 0};
+  char *heapTop = __brkval;
+  mazeInit(NULL);
+  mazeMarkVisited(0);
+  testFloodTrip(testMaze, GOAL_REGION, trace);
+  testFloodTrip(testMaze, 0, trace);
+  long updateAverage = trace.updateTime / trace.steps;
+  long floodAverage = trace.floodTime / trace.steps;
+  console << F("Steps: ") << trace.steps << F("  Errors: ") << trace.errors << endl;
+  console << F("  Update: ") << updateAverage << F("us (") << updateAverage * (F_CPU / 1000000L) << F(" cycles)") << endl;
+  console << F("  Flood:  ") << floodAverage << F("us (") << floodAverage * (F_CPU / 1000000L) << F(" cycles)") << endl;
+  console << F("  Heap used: ") << (int)(__brkval - heapTop) << F(" bytes") << endl;
+#if QUEUE_DEBUG
+  console << F("  Queue high water: ") << Queue<cell_t, FLOOD_QUEUE_SIZE>::highWater;
+  console << F("  Overflows: ") << Queue<cell_t, FLOOD_QUEUE_SIZE>::overflows << endl;
+#endif
+}
+
+/***
+ * Compare the bitboard flood with the simple queue based flood on one of
+ * the sample mazes. Each is run ten times to each of the goal and the start
+ * cell and the average time and cycle count is reported along with the
+ * number of cells, if any, where the two disagree.
+ *
+ * The queue based flood is timed as mazeFloodSecond(), which puts the
+ * same costs in costKnown[], so that there is no need for a copy of them.
+ *
+ * On exit, the map holds the sample maze.
+ */
+void testFloodBits(const unsigned char *testMaze) {
+  mazeInit(testMaze);
+  CellSet targets[] = {GOAL_REGION, 0};
+  for (unsigned char t = 0; t < 2; t++) {
+    const CellSet &target = targets[t];
+    unsigned long start = micros();
+    TENTIMES(mazeFloodSecond(target));
+    unsigned long middle = micros();
+    TENTIMES(mazeFloodBits(target));
+    unsigned long end = micros();
+    int errors = 0;
+    for (int i = 0; i < MAZE_CELLS; i++) {
+      if (costKnown[i] != cost[i]) {
+        errors++;
+      }
+    }
+    long floodTime = (middle - start) / 10;
+    long bitsTime = (end - middle) / 10;
+    console << F("Target: ") << target.cells[0] << F("  Errors: ") << errors << endl;
+    console << F("  Flood: ") << floodTime << F("us (") << floodTime * (F_CPU / 1000000L) << F(" cycles)") << endl;
+    console << F("  Bits:  ") << bitsTime << F("us (") << bitsTime * (F_CPU / 1000000L) << F(" cycles)") << endl;
+  }
+}
+
+/***
+ * Compare the dual flood with the optimistic and pessimistic floods done
+ * one after the other. A simulated search out to the goal leaves some of
+ * the walls unknown and then each flood is run ten times to the goal.
+ *
+ * Reports the number of cells where either cost map disagrees (there
+ * should be none), the average time and cycle count for each method and
+ * the time for the dual flood as a percentage of a single flood.
+ *
+ * Each cost map from the dual flood is checked against the other array
+ * filled by the single flood so that no copy is needed on the stack.
+ *
+ * On exit, the map holds the walls found by the simulated search.
+ */
+void testFloodDual(const unsigned char *testMaze) {
+  FloodTrace trace = {0, NORTH, 0, 0, 0, 0};
+  mazeInit(NULL);
+  mazeMarkVisited(0);
+  testFloodTrip(testMaze, GOAL_REGION, trace);
+  unsigned long start = micros();
+  TENTIMES(mazeFloodKnown(GOAL_REGION));
+  unsigned long middle = micros();
+  TENTIMES(mazeFlood(GOAL_REGION));
+  unsigned long end = micros();
+  long knownTime = (middle - start) / 10;
+  long floodTime = (end - middle) / 10;
+  start = micros();
+  TENTIMES(mazeFloodDual(GOAL_REGION));
+  end = micros();
+  long dualTime = (end - start) / 10;
+  int errors = 0;
+  mazeFloodSecond(GOAL_REGION);
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    if (costKnown[i] != cost[i]) {
+      errors++;
+    }
+  }
+  mazeFloodDual(GOAL_REGION);
+  mazeFloodKnown(GOAL_REGION);
+  for (int i = 0; i < MAZE_CELLS; i++) {
+    if (costKnown[i] != cost[i]) {
+      errors++;
+    }
+  }
+  console << F("Steps: ") << trace.steps << F("  Errors: ") << errors << endl;
+  console << F("  Known: ") << knownTime << F("us (") << knownTime * (F_CPU / 1000000L) << F(" cycles)") << endl;
+  console << F("  Flood: ") << floodTime << F("us (") << floodTime * (F_CPU / 1000000L) << F(" cycles)") << endl;
+  console << F("  Dual:  ") << dualTime << F("us (") << dualTime * (F_CPU / 1000000L) << F(" cycles) ");
+  console << (dualTime * 100) / floodTime << F("% of one flood") << endl;
+}
+
+/***
+ * Compare the route search with a full flood on one of the sample mazes,
+ * once from the start to the goal and once from the goal back home. Each
+ * is run ten times and the average time and cycle count are reported
+ * along with the route. The length must be the cost given by the flood.
+ *
+ * On exit, the map holds the sample maze and path[] the route home.
+ */
+void testRoute(const unsigned char *testMaze) {
+  mazeInit(testMaze);
+  CellSet targets[] = {GOAL_REGION, 0};
+  cell_t starts[] = {0, GOAL};
+  for (unsigned char t = 0; t < 2; t++) {
+    const CellSet &target = targets[t];
+    unsigned char heading = NORTH;
+    unsigned long start = micros();
+    TENTIMES(mazeFlood(target));
+    unsigned long middle = micros();
+    int length;
+    TENTIMES(length = pathRoute(starts[t], target, false, heading));
+    unsigned long end = micros();
+    long floodTime = (middle - start) / 10;
+    long routeTime = (end - middle) / 10;
+    console << F("From: ") << starts[t] << F("  Length: ") << length << F("  Flood cost: ") << cost[starts[t]] << endl;
+    console << F("  Flood: ") << floodTime << F("us (") << floodTime * (F_CPU / 1000000L) << F(" cycles)") << endl;
+    console << F("  Route: ") << routeTime << F("us (") << routeTime * (F_CPU / 1000000L) << F(" cycles)") << endl;
+    console << F("  ") << dirLetters[heading] << ' ' << path << endl;
+  }
+}
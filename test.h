@@ -28,6 +28,9 @@
 #ifndef TEST_H
 #define TEST_H
 
+#include "maze.h"
+#include "profile.h"
+
 // use these macros to run a function many times and test its execution time
 #define TENTIMES(x) do { x; x; x; x; x; x; x; x; x; x; } while (0)  //NOLINT
 #define FIFTYTIMES(x) do { TENTIMES(x); TENTIMES(x); TENTIMES(x); TENTIMES(x); TENTIMES(x); } while (0) //NOLINT
@@ -37,15 +40,21 @@ int getFreeRam();
 
 void testMove();
 void testForward(long distance, int maxSpeed);
+void testProfile(const MotionProfile &profile);
+void testStepGenerators();
 void testSensors();
 void testSteering();
 void testSteeringErrorSides();
 void testSteeringErrorFront();
 void testSensorEdge(int side);
 void testFollower(int target);
-void testSearcher(int target);
+void testSearcher(const CellSet &target);
 void testCalibrateFrontSensors();
 void testCalibrateSensors();
+void testFloodUpdate(const unsigned char *testMaze);
+void testFloodBits(const unsigned char *testMaze);
+void testFloodDual(const unsigned char *testMaze);
+void testRoute(const unsigned char *testMaze);
 
 class test {
 